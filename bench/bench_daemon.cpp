@@ -0,0 +1,235 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+#include "plan_generator.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+#if !defined(WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+namespace
+{
+    typedef std::chrono::steady_clock::time_point time_point;
+
+    struct connection_result
+    {
+        std::vector<double> latencies;
+        size_t              failed_count = 0;
+        std::string         error;
+    };
+
+#if !defined(WIN32)
+    int connectDaemon(const std::string& _socket_path)
+    {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (_socket_path.size() >= sizeof(address.sun_path))
+        {
+            return -1;
+        }
+        std::memcpy(address.sun_path, _socket_path.c_str(), _socket_path.size());
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0
+            && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // one client: a thread sends the requests while at most `_depth` of them are in flight, this one reads the responses.
+    void runConnection(const std::string& _socket_path, const std::string& _svg, size_t _request_count, size_t _depth, connection_result& _result)
+    {
+        const int fd = connectDaemon(_socket_path);
+        if (fd < 0)
+        {
+            _result.error = "can not connect to " + _socket_path;
+            _result.failed_count = _request_count;
+            return;
+        }
+
+        std::vector<time_point> send_times(_request_count);
+        std::mutex mutex;
+        std::condition_variable window;
+        size_t in_flight = 0;
+        std::thread sender([&]()
+        {
+            const uint32_t flags = bimpp::svgex::request_check | bimpp::svgex::request_rooms;
+            for (size_t i = 0; i < _request_count; ++i)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    window.wait(lock, [&]() { return in_flight < _depth; });
+                    ++in_flight;
+                    send_times[i] = std::chrono::steady_clock::now();
+                }
+                const bimpp::svgex::frame_header header = bimpp::svgex::make_frame_header(bimpp::svgex::request_magic, flags, i, _svg.size());
+                if (!bimpp::svgex::write_fully(fd, &header, sizeof(header))
+                    || !bimpp::svgex::write_fully(fd, _svg.data(), _svg.size()))
+                {
+                    return;
+                }
+            }
+        });
+
+        bimpp::svgex::frame_header header;
+        std::string payload;
+        bimpp::svgex::loader<>::house_cache_type bim_cache;
+        for (size_t i = 0; i < _request_count; ++i)
+        {
+            if (!bimpp::svgex::read_frame(fd, header, payload)
+                || !bimpp::svgex::is_frame(header, bimpp::svgex::response_magic)
+                || header.request_id >= _request_count)
+            {
+                _result.error = "the connection is broken";
+                _result.failed_count += _request_count - i;
+                break;
+            }
+            const time_point receive_time = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                _result.latencies.push_back(std::chrono::duration<double>(receive_time - send_times[header.request_id]).count());
+                --in_flight;
+            }
+            window.notify_one();
+
+            bimpp::svgex::response_body body;
+            if (header.code != static_cast<uint32_t>(bimpp::svgex::response_status::ok)
+                || payload.size() < sizeof(body))
+            {
+                _result.error = payload;
+                ++_result.failed_count;
+                continue;
+            }
+            std::memcpy(&body, payload.data(), sizeof(body));
+            if (!bim_cache.open(payload.data() + sizeof(body), payload.size() - sizeof(body), body.source_hash)
+                || body.room_status != 1)
+            {
+                _result.error = "invalid house";
+                ++_result.failed_count;
+            }
+            bim_cache.close();
+        }
+        // a broken connection also stops the sender.
+        ::shutdown(fd, SHUT_RDWR);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            in_flight = 0;
+        }
+        window.notify_all();
+        sender.join();
+        ::close(fd);
+    }
+#endif
+
+    double getPercentile(const std::vector<double>& _sorted, double _percentile)
+    {
+        if (_sorted.empty())
+        {
+            return 0.0;
+        }
+        const size_t index = static_cast<size_t>(_percentile / 100.0 * (_sorted.size() - 1) + 0.5);
+        return _sorted[std::min(index, _sorted.size() - 1)];
+    }
+}
+
+// bench_daemon <socket-path> [plan.svg|element-count] [connections] [requests-by-connection] [pipeline-depth]
+// the load of many clients on `svgex --daemon <socket-path>`, every request loads the plan and computes its rooms.
+int main(int argc, char* argv[])
+{
+#if defined(WIN32)
+    std::cerr << "the daemon is not supported on this platform" << std::endl;
+    return 1;
+#else
+    if (argc < 2)
+    {
+        std::cerr << "bench_daemon <socket-path> [plan.svg|element-count] [connections] [requests-by-connection] [pipeline-depth]" << std::endl;
+        return 1;
+    }
+    const std::string socket_path = argv[1];
+    const std::string plan = argc > 2 ? argv[2] : "10000";
+    const size_t connection_count = argc > 3 ? std::max<size_t>(std::strtoull(argv[3], nullptr, 10), 1) : 4;
+    const size_t request_count = argc > 4 ? std::max<size_t>(std::strtoull(argv[4], nullptr, 10), 1) : 250;
+    const size_t depth = argc > 5 ? std::max<size_t>(std::strtoull(argv[5], nullptr, 10), 1) : 8;
+
+    std::string svg;
+    if (!plan.empty() && std::isdigit(static_cast<unsigned char>(plan[0])))
+    {
+        bimpp::svgex::bench::plan_generator().generateElements(static_cast<size_t>(std::strtoull(plan.c_str(), nullptr, 10)), svg);
+    }
+    else if (!bimpp::svgex::read_file(plan, svg))
+    {
+        std::cerr << "can not read " << plan << std::endl;
+        return 1;
+    }
+
+    std::vector<connection_result> results(connection_count);
+    std::vector<std::thread> connections;
+    const time_point start_time = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < connection_count; ++i)
+    {
+        connections.emplace_back(runConnection, std::cref(socket_path), std::cref(svg), request_count, depth, std::ref(results[i]));
+    }
+    for (std::thread& connection : connections)
+    {
+        connection.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    std::vector<double> latencies;
+    size_t failed_count = 0;
+    for (const connection_result& result : results)
+    {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        failed_count += result.failed_count;
+        if (!result.error.empty())
+        {
+            std::cerr << result.error << std::endl;
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const size_t total_count = connection_count * request_count;
+    std::cout << total_count << " requests of " << svg.size() << " bytes, "
+        << connection_count << " connections, depth " << depth << ", " << failed_count << " failed" << std::endl
+        << std::fixed << std::setprecision(1)
+        << "throughput " << latencies.size() / seconds << " requests/s, "
+        << latencies.size() * svg.size() / seconds / (1024.0 * 1024.0) << " MB/s" << std::endl
+        << std::setprecision(3)
+        << "latency p50 " << getPercentile(latencies, 50) * 1000.0 << " ms, p90 " << getPercentile(latencies, 90) * 1000.0
+        << " ms, p99 " << getPercentile(latencies, 99) * 1000.0 << " ms, max " << getPercentile(latencies, 100) * 1000.0 << " ms" << std::endl;
+    return failed_count == 0 ? 0 : 1;
+#endif
+}
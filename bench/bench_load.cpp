@@ -0,0 +1,313 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+#include "plan_generator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <vector>
+
+#if !defined(WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    // every allocation of the process is counted, the live bytes are tracked with a header before the block.
+    std::atomic<size_t> allocation_count(0);
+    std::atomic<size_t> live_bytes(0);
+    std::atomic<size_t> peak_live_bytes(0);
+
+    const size_t allocation_header_size = 16;
+
+    void* countedAllocate(size_t _size)
+    {
+        char* block = static_cast<char*>(std::malloc(_size + allocation_header_size));
+        if (block == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        *reinterpret_cast<size_t*>(block) = _size;
+        ++allocation_count;
+        const size_t bytes = live_bytes += _size;
+        size_t peak_bytes = peak_live_bytes.load();
+        while (bytes > peak_bytes && !peak_live_bytes.compare_exchange_weak(peak_bytes, bytes))
+        {
+        }
+        return block + allocation_header_size;
+    }
+
+    void countedFree(void* _pointer)
+    {
+        if (_pointer == nullptr)
+        {
+            return;
+        }
+        char* block = static_cast<char*>(_pointer) - allocation_header_size;
+        live_bytes -= *reinterpret_cast<size_t*>(block);
+        std::free(block);
+    }
+
+    size_t getPeakRssKiB()
+    {
+#if defined(WIN32)
+        return 0;
+#else
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<size_t>(usage.ru_maxrss);
+#endif
+    }
+
+    struct phase_result
+    {
+        double  seconds = 0.0;
+        size_t  allocation_count = 0;
+        size_t  peak_bytes = 0;
+    };
+
+    // run `_prepare` untimed and `_phase` timed `_repeat` times, the best time is kept.
+    template<typename TPrepare, typename TPhase>
+    phase_result measure(size_t _repeat, TPrepare _prepare, TPhase _phase)
+    {
+        phase_result result;
+        for (size_t i = 0; i < _repeat; ++i)
+        {
+            _prepare();
+            const size_t start_allocation_count = allocation_count.load();
+            const size_t start_live_bytes = live_bytes.load();
+            peak_live_bytes.store(start_live_bytes);
+            const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+            _phase();
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            if (i == 0 || seconds < result.seconds)
+            {
+                result.seconds = seconds;
+            }
+            result.allocation_count = allocation_count.load() - start_allocation_count;
+            result.peak_bytes = peak_live_bytes.load() - start_live_bytes;
+        }
+        return result;
+    }
+
+    void report(const char* _name, const phase_result& _result, size_t _element_count, size_t _byte_count)
+    {
+        std::cout << std::setw(16) << _name
+            << std::setw(12) << std::fixed << std::setprecision(3) << _result.seconds * 1000.0 << " ms"
+            << std::setw(14) << std::setprecision(0) << _element_count / _result.seconds << " elements/s"
+            << std::setw(10) << std::setprecision(1) << _byte_count / _result.seconds / (1024.0 * 1024.0) << " MB/s"
+            << std::setw(10) << _result.allocation_count << " allocs"
+            << std::setw(8) << std::setprecision(2) << static_cast<double>(_result.allocation_count) / _element_count << " allocs/element"
+            << std::setw(10) << std::setprecision(1) << _result.peak_bytes / (1024.0 * 1024.0) << " MB peak"
+            << std::endl;
+    }
+
+    // the `bimpp` attributes of the svg as the loader decodes them, '\0' separated.
+    std::string collectBimPP(char* _svg)
+    {
+        rapidxml_ns::xml_document<> xml_doc;
+        xml_doc.parse<0>(_svg);
+        std::string bimpps;
+        rapidxml_ns::xml_node<>* xml_svg_element = xml_doc.first_node("svg");
+        for (rapidxml_ns::xml_node<>* xml_element = xml_svg_element->first_node(); xml_element != nullptr; xml_element = xml_element->next_sibling())
+        {
+            rapidxml_ns::xml_attribute<>* xml_attribute = xml_element->first_attribute("bimpp");
+            if (xml_attribute == nullptr)
+            {
+                continue;
+            }
+            std::string bimpp(xml_attribute->value(), xml_attribute->value_size());
+            std::replace(bimpp.begin(), bimpp.end(), '\'', '"');
+            bimpps += bimpp;
+            bimpps += '\0';
+        }
+        return bimpps;
+    }
+
+    void run(size_t _element_count, size_t _repeat)
+    {
+        typedef bimpp::svgex::loader<bimpp::plan2d::constant<>, bimpp::svgex::profile::metadata> loader_type;
+        typedef bimpp::svgex::loader<bimpp::plan2d::constant<>, bimpp::svgex::profile::full> full_loader_type;
+
+        std::string source;
+        const bimpp::svgex::bench::plan_counts counts = bimpp::svgex::bench::plan_generator().generateElements(_element_count, source);
+        const size_t element_count = counts.getElementCount();
+        const size_t byte_count = source.size();
+        std::cout << element_count << " elements (" << counts.node_count << " nodes, " << counts.wall_count << " walls, "
+            << counts.hole_count << " holes, " << counts.room_count << " rooms), " << byte_count << " bytes" << std::endl;
+
+        std::string svg;
+        const auto copySvg = [&]() { svg = source; };
+        const auto nothing = []() {};
+
+        rapidxml_ns::xml_document<> xml_doc;
+        report("xml parse", measure(_repeat, [&]() { copySvg(); xml_doc.clear(); }, [&]() { xml_doc.parse<0>(&svg[0]); }),
+            element_count, byte_count);
+        xml_doc.clear();
+
+        svg = source;
+        const std::string source_bimpps = collectBimPP(&svg[0]);
+        // the in situ parsing writes '\0' in the attributes, so they are found before.
+        std::vector<size_t> bimpp_offsets;
+        for (std::string::size_type position = 0; position < source_bimpps.size(); position = source_bimpps.find('\0', position) + 1)
+        {
+            bimpp_offsets.push_back(position);
+        }
+        std::string bimpps;
+        // the document is reset between the attributes in a fixed buffer as `decodeBimPP` does, so its pool does not grow.
+        std::vector<char> json_buffer(16 * 1024);
+        rapidjson::MemoryPoolAllocator<> json_allocator(json_buffer.data(), json_buffer.size());
+        rapidjson::GenericDocument<rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<>, rapidjson::MemoryPoolAllocator<>> json_doc(&json_allocator, 1024, &json_allocator);
+        report("json decode", measure(_repeat, [&]() { bimpps = source_bimpps; }, [&]()
+            {
+                for (const size_t offset : bimpp_offsets)
+                {
+                    json_doc.SetNull();
+                    json_allocator.Clear();
+                    json_doc.ParseInsitu<rapidjson::kParseFullPrecisionFlag>(&bimpps[offset]);
+                }
+            }), element_count, byte_count);
+
+        // the decoding before the in place parsing: the value was copied to a std::string by the error policy, copied again
+        // with its quotes rewritten by the context and once more at the end of the element, then parsed by a fresh document.
+        report("json per element", measure(_repeat, nothing, [&]()
+            {
+                for (const size_t offset : bimpp_offsets)
+                {
+                    const std::string attribute_value = &source_bimpps[offset];
+                    std::string current_bimpp = attribute_value;
+                    std::replace(current_bimpp.begin(), current_bimpp.end(), '\'', '"');
+                    const std::string bimpp_data = current_bimpp;
+                    rapidjson::Document json_per_element_doc;
+                    json_per_element_doc.Parse(bimpp_data.c_str());
+                }
+            }), element_count, byte_count);
+
+        loader_type::workspace bim_workspace;
+        loader_type::flat_house_type bim_flat_house;
+        std::string error_message;
+        report("load metadata", measure(_repeat, [&]() { copySvg(); bim_flat_house.reset(); }, [&]() { loader_type::load(svg, bim_flat_house, error_message, false, bim_workspace); }),
+            element_count, byte_count);
+
+        full_loader_type::workspace bim_full_workspace;
+        full_loader_type::flat_house_type bim_full_flat_house;
+        report("load full", measure(_repeat, [&]() { copySvg(); bim_full_flat_house.reset(); }, [&]() { full_loader_type::load(svg, bim_full_flat_house, error_message, false, bim_full_workspace); }),
+            element_count, byte_count);
+
+        loader_type::house_type bim_house;
+        report("load maps", measure(_repeat, [&]() { copySvg(); bim_house.reset(); }, [&]() { loader_type::load(svg, bim_house, error_message, false, bim_workspace); }),
+            element_count, byte_count);
+
+        // the handoff before the maps were moved: the loaded maps were copy-assigned to the house while they were still alive.
+        loader_type::house_type bim_loaded_house;
+        report("load maps copy", measure(_repeat, [&]() { copySvg(); bim_house.reset(); }, [&]()
+            {
+                loader_type::load(svg, bim_loaded_house, error_message, false, bim_workspace);
+                bim_house.nodes = bim_loaded_house.nodes;
+                bim_house.walls = bim_loaded_house.walls;
+                bim_house.holes = bim_loaded_house.holes;
+                bim_house.rooms = bim_loaded_house.rooms;
+                bim_loaded_house = loader_type::house_type();
+            }), element_count, byte_count);
+
+        // the memory held by the loaded houses, without the DOM of the workspace.
+        const auto heldBytes = [](std::function<void()> _release)
+        {
+            const size_t held_bytes = live_bytes.load();
+            _release();
+            return held_bytes - live_bytes.load();
+        };
+        svg = source;
+        loader_type::load(svg, bim_flat_house, error_message, false, bim_workspace);
+        const size_t flat_house_bytes = heldBytes([&]() { bim_flat_house = loader_type::flat_house_type(); });
+        svg = source;
+        loader_type::load(svg, bim_house, error_message, false, bim_workspace);
+        const size_t house_bytes = heldBytes([&]() { bim_house = loader_type::house_type(); });
+        std::cout << std::setw(16) << "house memory" << std::setw(12) << std::setprecision(1) << flat_house_bytes / (1024.0 * 1024.0) << " MB flat"
+            << std::setw(12) << house_bytes / (1024.0 * 1024.0) << " MB maps" << std::endl;
+        svg = source;
+        loader_type::load(svg, bim_flat_house, error_message, false, bim_workspace);
+
+        bimpp::svgex::validation_report validation;
+        report("validate", measure(_repeat, [&]() { validation.issues.clear(); }, [&]() { loader_type::validator_type::validate(bim_flat_house, validation, 1); }),
+            element_count, byte_count);
+
+        report("to house", measure(_repeat, nothing, [&]() { bim_flat_house.toHouse(bim_house); }),
+            element_count, byte_count);
+
+        const uint64_t source_hash = bimpp::svgex::hashSource(source.data(), source.size());
+        report("source hash", measure(_repeat, nothing, [&]() { bimpp::svgex::hashSource(source.data(), source.size()); }),
+            element_count, byte_count);
+        const std::string cache_path = "bench_load.bimpp";
+        report("cache save", measure(_repeat, nothing, [&]() { loader_type::house_cache_type::save(bim_house, source_hash, cache_path); }),
+            element_count, byte_count);
+        loader_type::house_cache_type bim_cache;
+        report("cache open", measure(_repeat, nothing, [&]() { bim_cache.open(cache_path, source_hash); }),
+            element_count, byte_count);
+        report("cache to house", measure(_repeat, nothing, [&]() { bim_cache.toHouse(bim_house); }),
+            element_count, byte_count);
+        bim_cache.close();
+        std::remove(cache_path.c_str());
+
+        bimpp::plan2d::algorithm<>::room_ex_vector bim_room_exs;
+        report("room exs", measure(_repeat, [&]() { bim_room_exs.clear(); }, [&]() { bimpp::plan2d::algorithm<>::computeRoomExs(bim_house, bim_room_exs); }),
+            element_count, byte_count);
+
+        std::cout << std::setw(16) << "peak rss" << std::setw(12) << getPeakRssKiB() / 1024 << " MB" << std::endl;
+    }
+}
+
+void* operator new(size_t _size)
+{
+    return countedAllocate(_size);
+}
+
+void operator delete(void* _pointer) noexcept
+{
+    countedFree(_pointer);
+}
+
+void operator delete(void* _pointer, size_t) noexcept
+{
+    countedFree(_pointer);
+}
+
+// bench_load [max-element-count] [repeat]
+// the plans grow tenfold from 1k elements, every phase keeps its best time of `repeat` runs.
+int main(int argc, char* argv[])
+{
+    const size_t max_element_count = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 1000000;
+    const size_t repeat = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : 0;
+    for (size_t element_count = 1000; element_count <= max_element_count; element_count *= 10)
+    {
+        run(element_count, repeat > 0 ? repeat : std::max<size_t>(100000 / element_count, 3));
+        std::cout << std::endl;
+    }
+    return 0;
+}
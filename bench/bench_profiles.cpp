@@ -0,0 +1,158 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cctype>
+
+namespace
+{
+    const size_t id_stride = 100000;
+
+    // add `_offset` to the integer after every `_key` in `_line`, all the integers of an array are shifted.
+    void shiftIds(std::string& _line, const std::string& _key, size_t _offset)
+    {
+        std::string::size_type position = 0;
+        while ((position = _line.find(_key, position)) != std::string::npos)
+        {
+            position += _key.size();
+            const bool is_array = position < _line.size() && _line[position] == '[';
+            for (;;)
+            {
+                while (position < _line.size() && !std::isdigit(static_cast<unsigned char>(_line[position])) && _line[position] != ']')
+                {
+                    ++position;
+                }
+                if (position >= _line.size() || _line[position] == ']')
+                {
+                    break;
+                }
+                std::string::size_type end = position;
+                while (end < _line.size() && std::isdigit(static_cast<unsigned char>(_line[end])))
+                {
+                    ++end;
+                }
+                const std::string shifted = std::to_string(std::stoull(_line.substr(position, end - position)) + _offset);
+                _line.replace(position, end - position, shifted);
+                position += shifted.size();
+                if (!is_array)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    // repeat the elements with `bimpp` attributes `_scale` times, the ids of every copy are shifted by `id_stride`.
+    std::string scalePlan(const std::string& _svg, size_t _scale, size_t& _element_count)
+    {
+        std::string header;
+        std::vector<std::string> elements;
+        std::string::size_type line_begin = 0;
+        while (line_begin < _svg.size())
+        {
+            std::string::size_type line_end = _svg.find('\n', line_begin);
+            line_end = line_end == std::string::npos ? _svg.size() : line_end + 1;
+            const std::string line = _svg.substr(line_begin, line_end - line_begin);
+            if (line.find("bimpp=") != std::string::npos)
+            {
+                elements.push_back(line);
+            }
+            else if (elements.empty())
+            {
+                header += line;
+            }
+            line_begin = line_end;
+        }
+
+        std::string scaled = header;
+        scaled.reserve(_svg.size() * _scale);
+        for (size_t k = 0; k < _scale; ++k)
+        {
+            for (std::string element : elements)
+            {
+                for (const char* key : { "'id':", "'start-node-id':", "'end-node-id':", "'wall-id':", "'wall-ids':" })
+                {
+                    shiftIds(element, key, k * id_stride);
+                }
+                scaled += element;
+            }
+        }
+        scaled += "</svg>\n";
+        _element_count = elements.size() * _scale;
+        return scaled;
+    }
+
+    template<typename TProfile>
+    void run(const char* _name, const std::string& _svg, size_t _element_count, size_t _repeat)
+    {
+        typedef bimpp::svgex::loader<bimpp::plan2d::constant<>, TProfile> loader_type;
+        typename loader_type::workspace bim_workspace;
+        double best_seconds = 0.0;
+        bool success = true;
+        for (size_t i = 0; i < _repeat; ++i)
+        {
+            std::string svg_context = _svg;
+            typename loader_type::flat_house_type bim_house;
+            std::string error_message;
+            const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+            success = loader_type::load(svg_context, bim_house, error_message, false, bim_workspace) && success;
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            best_seconds = i == 0 ? seconds : std::min(best_seconds, seconds);
+        }
+        std::cout << std::setw(20) << _name
+            << std::setw(12) << std::fixed << std::setprecision(3) << best_seconds * 1000.0 << " ms"
+            << std::setw(12) << std::setprecision(1) << _svg.size() / best_seconds / (1024.0 * 1024.0) << " MB/s"
+            << std::setw(14) << std::setprecision(0) << _element_count / best_seconds << " elements/s"
+            << (success ? "" : "  (failed)")
+            << std::endl;
+    }
+}
+
+// bench_profiles [plan.svg] [max-scale]
+int main(int argc, char* argv[])
+{
+    const std::string plan_path = argc > 1 ? argv[1] : BIMPP_SVGEX_SAMPLE_PLAN;
+    const size_t max_scale = argc > 2 ? static_cast<size_t>(std::strtoul(argv[2], nullptr, 10)) : 1000;
+    std::string source;
+    if (!bimpp::svgex::read_file(plan_path, source))
+    {
+        std::cerr << "can not read " << plan_path << std::endl;
+        return 1;
+    }
+
+    for (size_t scale = 1; scale <= max_scale; scale *= 10)
+    {
+        size_t element_count = 0;
+        const std::string svg = scalePlan(source, scale, element_count);
+        const size_t repeat = std::max<size_t>(1000 / scale, 3);
+        std::cout << "scale " << scale << ": " << element_count << " elements, " << svg.size() << " bytes" << std::endl;
+        run<bimpp::svgex::profile::metadata>("metadata", svg, element_count, repeat);
+        run<bimpp::svgex::profile::metadata_geometry>("metadata_geometry", svg, element_count, repeat);
+        run<bimpp::svgex::profile::full>("full", svg, element_count, repeat);
+    }
+    return 0;
+}
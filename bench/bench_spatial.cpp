@@ -0,0 +1,317 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+#include "plan_generator.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cstdlib>
+
+namespace
+{
+    typedef bimpp::svgex::loader<bimpp::plan2d::constant<>, bimpp::svgex::profile::metadata> loader_type;
+    typedef loader_type::spatial_index_type spatial_index_type;
+    typedef loader_type::precision_type precision_type;
+    typedef spatial_index_type::wall_segment wall_segment;
+
+    struct query_point
+    {
+        precision_type  x;
+        precision_type  y;
+    };
+
+    double measure(const std::function<void()>& _function)
+    {
+        const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        _function();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    }
+
+    void report(const char* _name, size_t _query_count, double _index_seconds, double _linear_seconds, size_t _mismatch_count)
+    {
+        std::cout << std::setw(16) << _name
+            << std::setw(12) << std::fixed << std::setprecision(3) << _index_seconds / _query_count * 1e6 << " us"
+            << std::setw(12) << std::setprecision(3) << _linear_seconds / _query_count * 1e6 << " us"
+            << std::setw(10) << std::setprecision(1) << _linear_seconds / _index_seconds << "x"
+            << (_mismatch_count == 0 ? "" : "  (" + std::to_string(_mismatch_count) + " mismatches)")
+            << std::endl;
+    }
+
+    // the nearest by the same rules as the index: the smallest squared distance, then the smallest id.
+    template<typename TDistance>
+    size_t findNearest(const std::vector<size_t>& _ids, precision_type _max_distance, TDistance _distance)
+    {
+        size_t nearest_id = spatial_index_type::npos;
+        precision_type best_distance = _max_distance * _max_distance;
+        for (size_t i = 0; i < _ids.size(); ++i)
+        {
+            const precision_type distance = _distance(i);
+            if (distance < best_distance || (distance == best_distance && (nearest_id == spatial_index_type::npos || _ids[i] < nearest_id)))
+            {
+                best_distance = distance;
+                nearest_id = _ids[i];
+            }
+        }
+        return nearest_id;
+    }
+
+    // the queries of `_index` against the linear scans over the walls and the nodes of `_house`,
+    // the random boxes are `_box_size` wide.
+    void compareQueries(const loader_type::house_type& _house, const spatial_index_type& _index, size_t _query_count, precision_type _box_size)
+    {
+        // the linear scans run over contiguous copies, not over the maps of the house.
+        std::vector<wall_segment> segments;
+        std::vector<size_t> wall_ids;
+        for (const auto& wall_pair : _house.walls)
+        {
+            const loader_type::node_type& start_node = _house.nodes.at(wall_pair.second.start_node_id);
+            const loader_type::node_type& end_node = _house.nodes.at(wall_pair.second.end_node_id);
+            segments.push_back(wall_segment{ wall_pair.first, start_node.x, start_node.y, end_node.x, end_node.y });
+            wall_ids.push_back(wall_pair.first);
+        }
+        std::vector<size_t> node_ids;
+        std::vector<query_point> nodes;
+        precision_type max_x = 0;
+        precision_type max_y = 0;
+        for (const auto& node_pair : _house.nodes)
+        {
+            node_ids.push_back(node_pair.first);
+            nodes.push_back(query_point{ node_pair.second.x, node_pair.second.y });
+            max_x = std::max(max_x, node_pair.second.x);
+            max_y = std::max(max_y, node_pair.second.y);
+        }
+
+        std::mt19937 random(7);
+        std::uniform_real_distribution<precision_type> random_x(-_box_size, max_x + _box_size);
+        std::uniform_real_distribution<precision_type> random_y(-_box_size, max_y + _box_size);
+        std::uniform_real_distribution<precision_type> random_offset(-0.75, 0.75);
+        std::vector<query_point> points(_query_count);
+        std::vector<query_point> snap_points(_query_count);
+        for (size_t i = 0; i < _query_count; ++i)
+        {
+            points[i] = query_point{ random_x(random), random_y(random) };
+            const query_point& node = nodes[random() % nodes.size()];
+            snap_points[i] = query_point{ node.x + random_offset(random), node.y + random_offset(random) };
+        }
+        const precision_type snap_tolerance = 1;
+        const precision_type no_limit = std::numeric_limits<precision_type>::max();
+
+        std::cout << std::setw(16) << "query" << std::setw(15) << "index" << std::setw(15) << "linear" << std::setw(11) << "speedup" << std::endl;
+
+        std::vector<std::vector<size_t>> index_results(_query_count);
+        std::vector<std::vector<size_t>> linear_results(_query_count);
+        size_t mismatch_count = 0;
+        const double index_box_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                _index.findWalls(points[i].x, points[i].y, points[i].x + _box_size, points[i].y + _box_size, index_results[i]);
+            }
+        });
+        const double linear_box_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                linear_results[i].clear();
+                for (const wall_segment& segment : segments)
+                {
+                    if (spatial_index_type::intersects(segment, points[i].x, points[i].y, points[i].x + _box_size, points[i].y + _box_size))
+                    {
+                        linear_results[i].push_back(segment.id);
+                    }
+                }
+            }
+        });
+        for (size_t i = 0; i < _query_count; ++i)
+        {
+            std::sort(index_results[i].begin(), index_results[i].end());
+            std::sort(linear_results[i].begin(), linear_results[i].end());
+            mismatch_count += index_results[i] != linear_results[i] ? 1 : 0;
+        }
+        report("box walls", _query_count, index_box_seconds, linear_box_seconds, mismatch_count);
+
+        mismatch_count = 0;
+        const double index_node_box_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                _index.findNodes(points[i].x, points[i].y, points[i].x + _box_size, points[i].y + _box_size, index_results[i]);
+            }
+        });
+        const double linear_node_box_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                linear_results[i].clear();
+                for (size_t k = 0; k < nodes.size(); ++k)
+                {
+                    if (nodes[k].x >= points[i].x && nodes[k].x <= points[i].x + _box_size
+                        && nodes[k].y >= points[i].y && nodes[k].y <= points[i].y + _box_size)
+                    {
+                        linear_results[i].push_back(node_ids[k]);
+                    }
+                }
+            }
+        });
+        for (size_t i = 0; i < _query_count; ++i)
+        {
+            std::sort(index_results[i].begin(), index_results[i].end());
+            std::sort(linear_results[i].begin(), linear_results[i].end());
+            mismatch_count += index_results[i] != linear_results[i] ? 1 : 0;
+        }
+        report("box nodes", _query_count, index_node_box_seconds, linear_node_box_seconds, mismatch_count);
+
+        std::vector<size_t> index_ids(_query_count);
+        std::vector<size_t> linear_ids(_query_count);
+        auto compare = [&]()
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                count += index_ids[i] != linear_ids[i] ? 1 : 0;
+            }
+            return count;
+        };
+
+        const double index_wall_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                index_ids[i] = _index.findNearestWall(points[i].x, points[i].y);
+            }
+        });
+        const double linear_wall_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                linear_ids[i] = findNearest(wall_ids, std::sqrt(no_limit), [&](size_t _k) { return spatial_index_type::getSquaredDistance(segments[_k], points[i].x, points[i].y); });
+            }
+        });
+        report("nearest wall", _query_count, index_wall_seconds, linear_wall_seconds, compare());
+
+        auto nodeDistance = [&](const query_point& _point, size_t _k)
+        {
+            const precision_type dx = nodes[_k].x - _point.x;
+            const precision_type dy = nodes[_k].y - _point.y;
+            return dx * dx + dy * dy;
+        };
+        const double index_node_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                index_ids[i] = _index.findNearestNode(points[i].x, points[i].y);
+            }
+        });
+        const double linear_node_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                linear_ids[i] = findNearest(node_ids, std::sqrt(no_limit), [&](size_t _k) { return nodeDistance(points[i], _k); });
+            }
+        });
+        report("nearest node", _query_count, index_node_seconds, linear_node_seconds, compare());
+
+        const double index_snap_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                index_ids[i] = _index.snapToNode(snap_points[i].x, snap_points[i].y, snap_tolerance);
+            }
+        });
+        const double linear_snap_seconds = measure([&]()
+        {
+            for (size_t i = 0; i < _query_count; ++i)
+            {
+                linear_ids[i] = findNearest(node_ids, snap_tolerance, [&](size_t _k) { return nodeDistance(snap_points[i], _k); });
+            }
+        });
+        report("snap to node", _query_count, index_snap_seconds, linear_snap_seconds, compare());
+    }
+
+    void buildIndex(const loader_type::house_type& _house, precision_type _cell_size, spatial_index_type& _index)
+    {
+        const double build_seconds = measure([&]() { _index.build(_house, _cell_size); });
+        std::cout << _house.walls.size() << " walls, " << _house.nodes.size() << " nodes, "
+            << _index.getColumnCount() << "x" << _index.getRowCount() << " cells, "
+            << std::setprecision(2) << static_cast<double>(_index.getWallCellCount()) / std::max<size_t>(_index.getWallCount(), 1) << " cells by wall, build "
+            << std::fixed << std::setprecision(3) << build_seconds * 1000.0 << " ms" << std::endl;
+    }
+
+    // long walls at 45 degrees between the points of a lattice, with the cells of the index on the lattice,
+    // so the walls go through the corners of the cells.
+    void generateDiagonalWalls(size_t _wall_count, precision_type _step, loader_type::house_type& _house)
+    {
+        _house.reset();
+        const size_t side = static_cast<size_t>(std::sqrt(static_cast<double>(_wall_count))) + 1;
+        std::mt19937 random(11);
+        for (size_t i = 0; i < _wall_count; ++i)
+        {
+            const size_t length = 1 + random() % 30;
+            const size_t x = random() % side;
+            const size_t y = length + random() % side;
+            const bool up = random() % 2 == 0;
+            _house.nodes.insert(loader_type::node_pair(2 * i, loader_type::node_type(x * _step, y * _step)));
+            _house.nodes.insert(loader_type::node_pair(2 * i + 1, loader_type::node_type((x + length) * _step, (up ? y + length : y - length) * _step)));
+            loader_type::wall_type bim_wall;
+            bim_wall.start_node_id = random() % 2 == 0 ? 2 * i : 2 * i + 1;
+            bim_wall.end_node_id = bim_wall.start_node_id == 2 * i ? 2 * i + 1 : 2 * i;
+            bim_wall.thickness = 1;
+            _house.walls.insert(loader_type::wall_pair(i, bim_wall));
+        }
+    }
+}
+
+// bench_spatial [wall-count] [query-count]
+// the queries of the index against the linear scans, over the walls and the nodes of a generated plan
+// and over diagonal walls which cross many cells.
+int main(int argc, char* argv[])
+{
+    const size_t wall_count = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 100000;
+    const size_t query_count = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : 10000;
+    const double cell_size = 300.0;
+
+    std::string svg;
+    bimpp::svgex::bench::plan_generator(cell_size).generateRooms(std::max<size_t>(wall_count / 2, 1), svg);
+    loader_type::house_type bim_house;
+    loader_type::workspace bim_workspace;
+    std::string error_message;
+    if (!loader_type::load(&svg[0], svg.size(), bim_house, error_message, false, bim_workspace))
+    {
+        std::cerr << error_message << std::endl;
+        return 1;
+    }
+    spatial_index_type bim_index;
+    std::cout << "plan: ";
+    buildIndex(bim_house, 0, bim_index);
+    compareQueries(bim_house, bim_index, query_count, 2 * cell_size);
+
+    const precision_type diagonal_step = 100;
+    generateDiagonalWalls(wall_count, diagonal_step, bim_house);
+    std::cout << std::endl << "diagonal walls: ";
+    buildIndex(bim_house, diagonal_step, bim_index);
+    compareQueries(bim_house, bim_index, query_count, 6 * diagonal_step);
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+namespace
+{
+    typedef bimpp::svgex::loader<> loader_type;
+    typedef loader_type::house_type house_type;
+    typedef loader_type::house_cache_type house_cache_type;
+
+    const uint64_t source_hash = 42;
+
+    size_t failure_count = 0;
+
+    void expect(bool _condition, const std::string& _what)
+    {
+        if (!_condition)
+        {
+            std::cerr << _what << std::endl;
+            ++failure_count;
+        }
+    }
+
+    // the cache is used in place, so it is copied to words which are aligned to 8 bytes.
+    std::vector<uint64_t> toWords(const std::string& _data)
+    {
+        std::vector<uint64_t> words((_data.size() + 7) / 8, 0);
+        std::memcpy(words.data(), _data.data(), _data.size());
+        return words;
+    }
+
+    bool openWords(house_cache_type& _cache, const std::vector<uint64_t>& _words, size_t _size)
+    {
+        return _cache.open(reinterpret_cast<const char*>(_words.data()), _size, source_hash);
+    }
+
+    // the record `_index` of the section which starts `_section_offset` bytes after the header.
+    template<typename TRecord>
+    TRecord* recordAt(std::vector<uint64_t>& _words, size_t _section_offset, size_t _index)
+    {
+        char* data = reinterpret_cast<char*>(_words.data());
+        const size_t header_size = (sizeof(house_cache_type::header) + 7) / 8 * 8;
+        return reinterpret_cast<TRecord*>(data + header_size + _section_offset) + _index;
+    }
+}
+
+// check_cache
+// a cache of the sample plan is opened, and copies with the ids of a section out of order are refused.
+int main()
+{
+    std::string svg;
+    house_type bim_house;
+    std::string error_message;
+    if (!bimpp::svgex::read_file(BIMPP_SVGEX_SAMPLE_PLAN, svg)
+        || !loader_type::load(svg, bim_house, error_message, false))
+    {
+        std::cerr << BIMPP_SVGEX_SAMPLE_PLAN << ": can not be loaded, " << error_message << std::endl;
+        return 1;
+    }
+    std::string data;
+    house_cache_type::serialize(bim_house, source_hash, data);
+    const std::vector<uint64_t> words = toWords(data);
+
+    house_cache_type bim_cache;
+    expect(openWords(bim_cache, words, data.size()), "the cache is refused");
+    house_type cached_house;
+    if (bim_cache.isOpen())
+    {
+        bim_cache.toHouse(cached_house);
+    }
+    expect(cached_house.nodes.size() == bim_house.nodes.size()
+        && cached_house.walls.size() == bim_house.walls.size()
+        && cached_house.rooms.size() == bim_house.rooms.size(), "the cached house differs");
+    expect(!openWords(bim_cache, words, data.size() - 8), "a truncated cache is opened");
+
+    // every section is aligned to 8 bytes, the records of the sample are already.
+    const size_t node_section_size = bim_house.nodes.size() * sizeof(house_cache_type::node_record);
+    const size_t wall_section_size = bim_house.walls.size() * sizeof(house_cache_type::wall_record);
+    const size_t hole_section_size = bim_house.holes.size() * sizeof(house_cache_type::hole_record);
+
+    std::vector<uint64_t> swapped_nodes = words;
+    std::swap(recordAt<house_cache_type::node_record>(swapped_nodes, 0, 0)->id,
+        recordAt<house_cache_type::node_record>(swapped_nodes, 0, 1)->id);
+    expect(!openWords(bim_cache, swapped_nodes, data.size()), "a cache with the nodes out of order is opened");
+
+    std::vector<uint64_t> repeated_walls = words;
+    recordAt<house_cache_type::wall_record>(repeated_walls, node_section_size, 1)->id
+        = recordAt<house_cache_type::wall_record>(repeated_walls, node_section_size, 0)->id;
+    expect(!openWords(bim_cache, repeated_walls, data.size()), "a cache with a repeated wall id is opened");
+
+    std::vector<uint64_t> swapped_rooms = words;
+    const size_t room_section_offset = node_section_size + wall_section_size + hole_section_size;
+    std::swap(recordAt<house_cache_type::room_record>(swapped_rooms, room_section_offset, 0)->id,
+        recordAt<house_cache_type::room_record>(swapped_rooms, room_section_offset, 1)->id);
+    expect(!openWords(bim_cache, swapped_rooms, data.size()), "a cache with the rooms out of order is opened");
+
+    std::cout << failure_count << " failed" << std::endl;
+    return failure_count == 0 ? 0 : 1;
+}
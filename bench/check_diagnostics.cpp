@@ -0,0 +1,78 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    typedef bimpp::svgex::loader<> loader_type;
+    typedef loader_type::house_type house_type;
+
+    size_t failure_count = 0;
+
+    void expect(bool _condition, const std::string& _what)
+    {
+        if (!_condition)
+        {
+            std::cerr << _what << std::endl;
+            ++failure_count;
+        }
+    }
+
+    // the entities before the faulty elements are translated in place by the parsing: the character references
+    // become line breaks, and `&lt;` becomes the '<' of a fake tag, which the text of the svg must not be taken for.
+    void checkEntities()
+    {
+        std::string svg =
+            "<svg xmlns=\"http://www.w3.org/2000/svg\">\n"
+            "<g id=\"a&#10;&#10;&#10;&#10;&lt;circle\">\n"
+            "<title>&lt;line&gt;&#10;&#10;&amp;&#10;</title>\n"
+            "</g>\n"
+            "<path d=\"M0,0 L1,1\" data-x=\"&#10;&#10;&lt;g\" bimpp=\"{'type':'room','id':1,'wall-ids':[]}\" />\n"
+            "<circle cx=\"1\" cy=\"1\" r=\"1\"\n"
+            "    bimpp=\"{'type':'node','x':1,'y':1}\" />\n"
+            "</svg>\n";
+        house_type bim_house;
+        std::string error_message;
+        bimpp::svgex::diagnostics bim_diagnostics;
+        loader_type::load(svg, bim_house, error_message, bim_diagnostics);
+        expect(bim_diagnostics.getCount() == 2, std::to_string(bim_diagnostics.getCount()) + " diagnostics instead of 2");
+        for (const bimpp::svgex::diagnostic& entry : bim_diagnostics.getEntries())
+        {
+            const bool on_path = entry.detail == to_string(bimpp::svgex::rejection_reason::invalid_room);
+            expect(entry.line == (on_path ? 5u : 7u) && entry.element == (on_path ? "path" : "circle"),
+                "expected line " + std::string(on_path ? "5, <path>" : "7, <circle>") + ": " + bimpp::svgex::to_string(entry));
+        }
+    }
+}
+
+// check_diagnostics
+// the lines and the elements of the diagnostics of a lenient loading, it exits with 1 if one is wrong.
+int main()
+{
+    checkEntities();
+    std::cout << failure_count << " failed" << std::endl;
+    return failure_count == 0 ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    typedef bimpp::svgex::loader<> loader_type;
+    typedef loader_type::house_type house_type;
+
+    size_t failure_count = 0;
+
+    void expect(bool _condition, const std::string& _what)
+    {
+        if (!_condition)
+        {
+            std::cerr << _what << std::endl;
+            ++failure_count;
+        }
+    }
+
+    std::string nodeElement(size_t _id, int _x, int _y)
+    {
+        return "<circle cx=\"" + std::to_string(_x) + "\" cy=\"" + std::to_string(_y) + "\" r=\"0.5\" bimpp=\"{'type':'node','id':"
+            + std::to_string(_id) + ",'x':" + std::to_string(_x) + ",'y':" + std::to_string(_y) + "}\" />";
+    }
+
+    std::string wallElement(size_t _id, size_t _start_node_id, size_t _end_node_id)
+    {
+        return "<line stroke-width=\"1\" bimpp=\"{'type':'wall','id':" + std::to_string(_id) + ",'start-node-id':" + std::to_string(_start_node_id)
+            + ",'end-node-id':" + std::to_string(_end_node_id) + ",'thickness':1}\" />";
+    }
+
+    std::string holeElement(size_t _id, size_t _wall_id)
+    {
+        return "<line stroke-width=\"1\" bimpp=\"{'type':'hole','id':" + std::to_string(_id) + ",'kind':'door','direction':'','wall-id':"
+            + std::to_string(_wall_id) + ",'width':0.5,'distance':0.25}\" />";
+    }
+
+    std::string roomElement(size_t _id, size_t _first_wall_id, const char* _d = "M0,0 L1,0 L0,1 z")
+    {
+        return "<path d=\"" + std::string(_d) + "\" bimpp=\"{'type':'room','id':" + std::to_string(_id) + ",'wall-ids':["
+            + std::to_string(_first_wall_id) + "," + std::to_string(_first_wall_id + 1) + "," + std::to_string(_first_wall_id + 2) + "]}\" />";
+    }
+
+    // two triangular rooms: the room 0 of the walls 0 to 2 and the room 1 of the walls 3 to 5.
+    std::vector<std::string> twoRooms()
+    {
+        std::vector<std::string> elements;
+        for (size_t i = 0; i < 6; ++i)
+        {
+            elements.push_back(nodeElement(i, static_cast<int>(i % 3 == 1) + static_cast<int>(i / 3) * 4, static_cast<int>(i % 3 == 2)));
+        }
+        for (size_t i = 0; i < 6; ++i)
+        {
+            elements.push_back(wallElement(i, i, i % 3 == 2 ? i - 2 : i + 1));
+        }
+        elements.push_back(roomElement(0, 0));
+        elements.push_back(roomElement(1, 3));
+        return elements;
+    }
+
+    std::string makeSvg(const std::vector<std::string>& _elements)
+    {
+        std::string svg = "<?xml version=\"1.0\" ?>\n<svg width=\"8px\" height=\"8px\" xmlns=\"http://www.w3.org/2000/svg\">\n";
+        for (const std::string& element : _elements)
+        {
+            svg += "\t" + element + "\n";
+        }
+        return svg + "</svg>\n";
+    }
+
+    // the houses are equal if `svg_writer` writes the same svg for them.
+    bool sameHouse(const house_type& _expected, const house_type& _actual)
+    {
+        std::string expected_svg;
+        std::string actual_svg;
+        return loader_type::svg_writer_type::write(_expected, expected_svg)
+            && loader_type::svg_writer_type::write(_actual, actual_svg)
+            && expected_svg == actual_svg;
+    }
+
+    // reload the svg of `_elements` and check that the house is the one which `load` builds from the same svg.
+    bool reload(const std::string& _name, const std::vector<std::string>& _elements, house_type& _house,
+        loader_type::incremental_state& _state, bimpp::svgex::house_delta& _delta)
+    {
+        std::string svg = makeSvg(_elements);
+        std::string loaded_svg = svg;
+        std::string error_message;
+        if (!loader_type::reload(svg, _house, _state, _delta, error_message))
+        {
+            expect(false, _name + ": the reload fails, " + error_message);
+            return false;
+        }
+        house_type loaded_house;
+        expect(loader_type::load(loaded_svg, loaded_house, error_message), _name + ": the load fails, " + error_message);
+        expect(sameHouse(loaded_house, _house), _name + ": the reloaded house differs from the loaded house");
+        return true;
+    }
+
+    std::vector<size_t> affectedRooms(const house_type& _house, const loader_type::incremental_state& _state, const bimpp::svgex::house_delta& _delta)
+    {
+        std::vector<size_t> room_ids;
+        bimpp::svgex::collectAffectedRooms(_house, _state.getIndex(), _delta, room_ids);
+        return room_ids;
+    }
+
+    // a door which moves to a wall of another room opens that room and closes the room it leaves.
+    void checkMovedHole()
+    {
+        house_type bim_house;
+        loader_type::incremental_state bim_state;
+        bimpp::svgex::house_delta bim_delta;
+        std::vector<std::string> elements = twoRooms();
+        elements.push_back(holeElement(0, 1));
+        if (!reload("moved hole", elements, bim_house, bim_state, bim_delta))
+        {
+            return;
+        }
+        elements.back() = holeElement(0, 4);
+        if (!reload("moved hole", elements, bim_house, bim_state, bim_delta))
+        {
+            return;
+        }
+        expect(bim_delta.holes.changed == std::vector<size_t>{ 0 } && bim_delta.size() == 1, "moved hole: the delta is not the hole");
+        expect(affectedRooms(bim_house, bim_state, bim_delta) == std::vector<size_t>{ 0, 1 }, "moved hole: the rooms of both walls are not affected");
+
+        elements.pop_back();
+        if (!reload("removed hole", elements, bim_house, bim_state, bim_delta))
+        {
+            return;
+        }
+        expect(bim_delta.holes.removed == std::vector<size_t>{ 0 } && bim_delta.size() == 1, "removed hole: the delta is not the hole");
+        expect(affectedRooms(bim_house, bim_state, bim_delta) == std::vector<size_t>{ 1 }, "removed hole: the room of its wall is not the only affected room");
+    }
+
+    // the rooms of a changed node or wall are found from the index, and a path which only moves is a changed room.
+    void checkEdits()
+    {
+        house_type bim_house;
+        loader_type::incremental_state bim_state;
+        bimpp::svgex::house_delta bim_delta;
+        std::vector<std::string> elements = twoRooms();
+        if (!reload("edits", elements, bim_house, bim_state, bim_delta))
+        {
+            return;
+        }
+        expect(bim_delta.nodes.added.size() == 6 && bim_delta.walls.added.size() == 6 && bim_delta.rooms.added.size() == 2,
+            "edits: the first reload does not add every entity");
+
+        reload("unchanged", elements, bim_house, bim_state, bim_delta);
+        expect(bim_delta.empty(), "unchanged: the delta is not empty");
+
+        elements[1] = nodeElement(1, 2, 0);
+        reload("moved node", elements, bim_house, bim_state, bim_delta);
+        expect(bim_delta.nodes.changed == std::vector<size_t>{ 1 } && bim_delta.size() == 1, "moved node: the delta is not the node");
+        expect(affectedRooms(bim_house, bim_state, bim_delta) == std::vector<size_t>{ 0 }, "moved node: the room of its walls is not the only affected room");
+
+        elements[6 + 3] = wallElement(3, 4, 3);
+        reload("changed wall", elements, bim_house, bim_state, bim_delta);
+        expect(bim_delta.walls.changed == std::vector<size_t>{ 3 } && bim_delta.size() == 1, "changed wall: the delta is not the wall");
+        expect(affectedRooms(bim_house, bim_state, bim_delta) == std::vector<size_t>{ 1 }, "changed wall: the room of the wall is not the only affected room");
+
+        elements[12] = roomElement(0, 0, "M0,0 L2,0 L0,1 z");
+        reload("moved path", elements, bim_house, bim_state, bim_delta);
+        expect(bim_delta.rooms.changed == std::vector<size_t>{ 0 } && bim_delta.size() == 1, "moved path: the delta is not the room");
+
+        // the room 1 leaves the walls 3 to 5 for the walls 0 to 2, the index follows it.
+        elements[13] = roomElement(1, 0);
+        reload("changed room", elements, bim_house, bim_state, bim_delta);
+        elements[6 + 4] = wallElement(4, 5, 4);
+        reload("changed wall", elements, bim_house, bim_state, bim_delta);
+        expect(affectedRooms(bim_house, bim_state, bim_delta).empty(), "changed wall: a room which left the wall is affected");
+        elements[6 + 1] = wallElement(1, 2, 1);
+        reload("changed wall", elements, bim_house, bim_state, bim_delta);
+        expect(affectedRooms(bim_house, bim_state, bim_delta) == std::vector<size_t>{ 0, 1 }, "changed wall: the rooms of the wall are not affected");
+    }
+
+    // `load` keeps the first element of a repeated id, so `reload` refuses the id instead of following
+    // which element wins when one of them is removed.
+    void checkRepeatedId()
+    {
+        house_type bim_house;
+        loader_type::incremental_state bim_state;
+        bimpp::svgex::house_delta bim_delta;
+        std::string error_message;
+        std::vector<std::string> elements = twoRooms();
+        elements.push_back(nodeElement(0, 9, 9));
+        std::string svg = makeSvg(elements);
+        expect(!loader_type::reload(svg, bim_house, bim_state, bim_delta, error_message) && bim_state.size() == 0,
+            "repeated id: the reload of a repeated node succeeds");
+
+        // the first node 0 is removed, the other one is the only node 0 of the svg.
+        elements.erase(elements.begin());
+        reload("repeated id", elements, bim_house, bim_state, bim_delta);
+        expect(bim_house.nodes.count(0) > 0 && bim_house.nodes.at(0).x == 9, "repeated id: the remaining node 0 is not loaded");
+
+        elements.push_back(elements.front());
+        svg = makeSvg(elements);
+        expect(!loader_type::reload(svg, bim_house, bim_state, bim_delta, error_message), "repeated id: the reload of a repeated element succeeds");
+        elements.pop_back();
+        reload("repeated id", elements, bim_house, bim_state, bim_delta);
+        elements.push_back(wallElement(0, 2, 1));
+        svg = makeSvg(elements);
+        expect(!loader_type::reload(svg, bim_house, bim_state, bim_delta, error_message), "repeated id: the reload of a repeated wall succeeds");
+        elements.pop_back();
+        reload("repeated id", elements, bim_house, bim_state, bim_delta);
+    }
+}
+
+// check_incremental
+// edits a small plan and checks the house, the delta and the affected rooms of every `reload`, it exits with 1 if one differs.
+int main()
+{
+    checkEdits();
+    checkMovedHole();
+    checkRepeatedId();
+    std::cout << failure_count << " failed" << std::endl;
+    return failure_count == 0 ? 0 : 1;
+}
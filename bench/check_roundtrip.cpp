@@ -0,0 +1,325 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+
+#include <iostream>
+#include <random>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    typedef bimpp::svgex::loader<> loader_type;
+    typedef loader_type::house_type house_type;
+    typedef loader_type::precision_type precision_type;
+
+    // the first difference of two houses, empty if they are equal. the numbers are compared exactly.
+    std::string compareHouses(const house_type& _expected, const house_type& _actual)
+    {
+        if (_expected.nodes.size() != _actual.nodes.size()
+            || _expected.walls.size() != _actual.walls.size()
+            || _expected.holes.size() != _actual.holes.size()
+            || _expected.rooms.size() != _actual.rooms.size())
+        {
+            return "the entity counts";
+        }
+        for (const auto& node_pair : _expected.nodes)
+        {
+            const auto itr = _actual.nodes.find(node_pair.first);
+            if (itr == _actual.nodes.end()
+                || itr->second.x != node_pair.second.x
+                || itr->second.y != node_pair.second.y)
+            {
+                return "node " + std::to_string(node_pair.first);
+            }
+        }
+        for (const auto& wall_pair : _expected.walls)
+        {
+            const auto itr = _actual.walls.find(wall_pair.first);
+            if (itr == _actual.walls.end()
+                || itr->second.start_node_id != wall_pair.second.start_node_id
+                || itr->second.end_node_id != wall_pair.second.end_node_id
+                || itr->second.thickness != wall_pair.second.thickness
+                || itr->second.kind != wall_pair.second.kind)
+            {
+                return "wall " + std::to_string(wall_pair.first);
+            }
+        }
+        for (const auto& hole_pair : _expected.holes)
+        {
+            const auto itr = _actual.holes.find(hole_pair.first);
+            if (itr == _actual.holes.end()
+                || itr->second.wall_id != hole_pair.second.wall_id
+                || itr->second.distance != hole_pair.second.distance
+                || itr->second.width != hole_pair.second.width
+                || itr->second.kind != hole_pair.second.kind
+                || itr->second.direction != hole_pair.second.direction)
+            {
+                return "hole " + std::to_string(hole_pair.first);
+            }
+        }
+        for (const auto& room_pair : _expected.rooms)
+        {
+            const auto itr = _actual.rooms.find(room_pair.first);
+            if (itr == _actual.rooms.end()
+                || itr->second.wall_ids != room_pair.second.wall_ids
+                || itr->second.kind != room_pair.second.kind)
+            {
+                return "room " + std::to_string(room_pair.first);
+            }
+        }
+        return std::string();
+    }
+
+    // write the house, load it back and compare them, the failure is printed with `_name`.
+    bool checkHouse(const std::string& _name, const house_type& _house, bool _check = true)
+    {
+        std::string svg;
+        if (!loader_type::svg_writer_type::write(_house, svg))
+        {
+            std::cerr << _name << ": can not be written" << std::endl;
+            return false;
+        }
+        house_type bim_house;
+        std::string error_message;
+        if (!loader_type::load(svg, bim_house, error_message, _check))
+        {
+            std::cerr << _name << ": can not be loaded back, " << error_message << std::endl;
+            return false;
+        }
+        const std::string difference = compareHouses(_house, bim_house);
+        if (!difference.empty())
+        {
+            std::cerr << _name << ": " << difference << " differs" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // the values of the random houses: short decimals, integers, and doubles with all their bits over many magnitudes.
+    class value_generator
+    {
+    public:
+        explicit value_generator(uint64_t _seed)
+            : engine(_seed)
+        {}
+
+        precision_type nextNumber(bool _positive)
+        {
+            std::uniform_real_distribution<double> unit(_positive ? 0.0 : -1.0, 1.0);
+            double value = 0.0;
+            switch (engine() % 4)
+            {
+            case 0:
+                {
+                    const double scale = std::pow(10.0, static_cast<double>(engine() % 7));
+                    value = std::round(unit(engine) * 1e5 * scale) / scale;
+                }
+                break;
+            case 1:
+                value = std::round(unit(engine) * 1e9);
+                break;
+            case 2:
+                value = unit(engine) * 1e5;
+                break;
+            default:
+                value = std::ldexp(unit(engine), static_cast<int>(engine() % 121) - 60);
+                break;
+            }
+            if (_positive && value <= 0.0)
+            {
+                value = 1.0;
+            }
+            return static_cast<precision_type>(value);
+        }
+
+        // the kinds hold the characters which the writer escapes.
+        std::string nextKind()
+        {
+            static const char* const kinds[] = { "", "door", "window", "a'b", "a\"b", "a&b<c>", "back\\slash", "\xe9\x97\xa8" };
+            return kinds[engine() % (sizeof(kinds) / sizeof(kinds[0]))];
+        }
+
+        size_t nextIndex(size_t _count)
+        {
+            return static_cast<size_t>(engine() % _count);
+        }
+
+    private:
+        std::mt19937_64 engine;
+    };
+
+    // a house whose references are valid, so it is loaded back with the check.
+    void generateHouse(value_generator& _values, size_t _node_count, house_type& _house)
+    {
+        _house.reset();
+        for (size_t i = 0; i < _node_count; ++i)
+        {
+            _house.nodes.insert(loader_type::node_pair(i, loader_type::node_type(_values.nextNumber(false), _values.nextNumber(false))));
+        }
+        for (size_t i = 0; i + 1 < _node_count; ++i)
+        {
+            loader_type::wall_type bim_wall;
+            bim_wall.start_node_id = i;
+            bim_wall.end_node_id = i + 1;
+            bim_wall.thickness = _values.nextNumber(true);
+            bim_wall.kind = _values.nextKind();
+            _house.walls.insert(loader_type::wall_pair(i, bim_wall));
+        }
+        const size_t wall_count = _house.walls.size();
+        for (size_t i = 0; i < wall_count / 2; ++i)
+        {
+            loader_type::hole_type bim_hole;
+            bim_hole.wall_id = _values.nextIndex(wall_count);
+            bim_hole.distance = _values.nextNumber(true);
+            bim_hole.width = _values.nextNumber(true);
+            bim_hole.kind = _values.nextKind();
+            bim_hole.direction = _values.nextKind();
+            _house.holes.insert(loader_type::hole_pair(i, bim_hole));
+        }
+        for (size_t i = 0; i < wall_count / 4; ++i)
+        {
+            // the loader drops the repeated walls of a room, so they are distinct here.
+            loader_type::room_type bim_room;
+            const size_t first_wall_id = _values.nextIndex(wall_count);
+            for (size_t j = 0; j < 4; ++j)
+            {
+                bim_room.wall_ids.push_back((first_wall_id + j) % wall_count);
+            }
+            bim_room.kind = _values.nextKind();
+            _house.rooms.insert(loader_type::room_pair(i, bim_room));
+        }
+    }
+}
+
+// check_roundtrip [plan.svg ...] [--random <house-count>]
+// every plan and every random house is written by `svg_writer` and loaded back, it exits with 1 if one differs.
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> paths;
+    size_t random_count = 100;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--random") == 0
+            && i + 1 < argc)
+        {
+            random_count = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty())
+    {
+        paths.push_back(BIMPP_SVGEX_SAMPLE_PLAN);
+    }
+
+    size_t failure_count = 0;
+    for (const std::string& path : paths)
+    {
+        std::string svg;
+        house_type bim_house;
+        std::string error_message;
+        if (!bimpp::svgex::read_file(path, svg)
+            || !loader_type::load(svg, bim_house, error_message, false))
+        {
+            std::cerr << path << ": can not be loaded, " << error_message << std::endl;
+            ++failure_count;
+            continue;
+        }
+        if (!checkHouse(path, bim_house))
+        {
+            ++failure_count;
+        }
+    }
+
+    value_generator values(random_count);
+    house_type bim_house;
+    for (size_t i = 0; i < random_count; ++i)
+    {
+        generateHouse(values, 2 + values.nextIndex(200), bim_house);
+        if (!checkHouse("random house " + std::to_string(i), bim_house))
+        {
+            ++failure_count;
+        }
+    }
+
+    // a value which json can not hold makes the writing fail instead of writing a house which reads back differently.
+    generateHouse(values, 2, bim_house);
+    bim_house.nodes.begin()->second.x = std::numeric_limits<precision_type>::quiet_NaN();
+    std::string svg;
+    if (loader_type::svg_writer_type::write(bim_house, svg))
+    {
+        std::cerr << "a house with a nan is written" << std::endl;
+        ++failure_count;
+    }
+
+    // the walls of a room are chained into a closed ring whatever their order and direction, and a room without
+    // a wall which has its nodes is written without a `d`, not with an empty path. the loader refuses a room
+    // without wall ids, so the empty room has the id of a missing wall and is loaded back without the check.
+    bim_house.reset();
+    const precision_type corners[4][2] = { { 0, 0 }, { 4, 0 }, { 4, 3 }, { 0, 3 } };
+    for (size_t i = 0; i < 4; ++i)
+    {
+        bim_house.nodes.insert(loader_type::node_pair(i, loader_type::node_type(corners[i][0], corners[i][1])));
+        loader_type::wall_type bim_wall;
+        bim_wall.start_node_id = i % 2 == 0 ? i : (i + 1) % 4;
+        bim_wall.end_node_id = i % 2 == 0 ? (i + 1) % 4 : i;
+        bim_wall.thickness = 1;
+        bim_house.walls.insert(loader_type::wall_pair(i, bim_wall));
+    }
+    loader_type::room_type bim_room;
+    bim_room.wall_ids = { 0, 2, 1, 3 };
+    bim_house.rooms.insert(loader_type::room_pair(0, bim_room));
+    bim_room.wall_ids = { 7 };
+    bim_house.rooms.insert(loader_type::room_pair(1, bim_room));
+    if (!loader_type::svg_writer_type::write(bim_house, svg))
+    {
+        std::cerr << "the rooms can not be written" << std::endl;
+        ++failure_count;
+    }
+    else
+    {
+        if (svg.find("<path d=\"M0,0 4,0 4,3 0,3 z \"") == std::string::npos)
+        {
+            std::cerr << "the walls of a room are not chained into a ring" << std::endl;
+            ++failure_count;
+        }
+        if (svg.find("d=\"\"") != std::string::npos
+            || svg.find("<path fill-rule") == std::string::npos)
+        {
+            std::cerr << "a room without walls is written with an empty path" << std::endl;
+            ++failure_count;
+        }
+    }
+    if (!checkHouse("the empty room", bim_house, false))
+    {
+        ++failure_count;
+    }
+
+    std::cout << paths.size() << " plans, " << random_count << " random houses, " << failure_count << " failed" << std::endl;
+    return failure_count == 0 ? 0 : 1;
+}
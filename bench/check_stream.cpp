@@ -0,0 +1,146 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <bimpp/svgex.hpp>
+
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    typedef bimpp::svgex::loader<> loader_type;
+    typedef bimpp::svgex::loader<bimpp::plan2d::constant<>, bimpp::svgex::profile::metadata> metadata_loader_type;
+    typedef loader_type::house_type house_type;
+
+    size_t failure_count = 0;
+
+    void expect(bool _condition, const std::string& _what)
+    {
+        if (!_condition)
+        {
+            std::cerr << _what << std::endl;
+            ++failure_count;
+        }
+    }
+
+    // the houses are equal if `svg_writer` writes the same svg for them.
+    bool sameHouse(const house_type& _expected, const house_type& _actual)
+    {
+        std::string expected_svg;
+        std::string actual_svg;
+        return loader_type::svg_writer_type::write(_expected, expected_svg)
+            && loader_type::svg_writer_type::write(_actual, actual_svg)
+            && expected_svg == actual_svg;
+    }
+
+    // `stream` from a buffer and from chunks of every size up to 64 bytes, and `reload`, build the house of `load`.
+    void checkSvg(const std::string& _name, const std::string& _svg)
+    {
+        std::string error_message;
+        std::string svg_context = _svg;
+        house_type loaded_house;
+        if (!loader_type::load(svg_context, loaded_house, error_message))
+        {
+            expect(false, _name + ": the load fails, " + error_message);
+            return;
+        }
+        svg_context = _svg;
+        house_type metadata_house;
+        expect(metadata_loader_type::load(svg_context, metadata_house, error_message) && sameHouse(loaded_house, metadata_house),
+            _name + ": the metadata profile loads another house");
+
+        svg_context = _svg;
+        loader_type::flat_house_type flat_house;
+        house_type streamed_house;
+        expect(loader_type::stream(&svg_context[0], svg_context.size(), flat_house, error_message), _name + ": the stream fails, " + error_message);
+        flat_house.toHouse(streamed_house);
+        expect(sameHouse(loaded_house, streamed_house), _name + ": the streamed house differs from the loaded house");
+
+        for (size_t chunk_size = 1; chunk_size <= 64; ++chunk_size)
+        {
+            std::istringstream svg_input(_svg);
+            flat_house.reset();
+            expect(loader_type::stream(svg_input, flat_house, error_message, chunk_size), _name + ": the chunked stream fails, " + error_message);
+            flat_house.toHouse(streamed_house);
+            expect(sameHouse(loaded_house, streamed_house), _name + ": the house streamed by " + std::to_string(chunk_size) + " bytes differs from the loaded house");
+        }
+
+        svg_context = _svg;
+        house_type reloaded_house;
+        loader_type::incremental_state bim_state;
+        bimpp::svgex::house_delta bim_delta;
+        expect(loader_type::reload(svg_context, reloaded_house, bim_state, bim_delta, error_message), _name + ": the reload fails, " + error_message);
+        expect(sameHouse(loaded_house, reloaded_house), _name + ": the reloaded house differs from the loaded house");
+    }
+
+    // the `bimpp` attributes which `load` does not decode: in a group, in the definitions, on another element and deeper.
+    const char decoy_svg[] =
+        "<?xml version=\"1.0\" ?>\n"
+        "<!-- <circle bimpp=\"{'type':'node','id':90,'x':0,'y':0}\" /> -->\n"
+        "<svg width=\"8px\" height=\"8px\" xmlns=\"http://www.w3.org/2000/svg\" bimpp=\"{'type':'node','id':50,'x':5,'y':5}\">\n"
+        "\t<defs>\n"
+        "\t\t<path d=\"M0,0 L1,1\" bimpp=\"{'type':'room','id':91,'wall-ids':[0]}\" />\n"
+        "\t\t<circle cx=\"1\" cy=\"1\" r=\"1\" bimpp=\"{'type':'node','id':0,'x':9,'y':9}\" />\n"
+        "\t</defs>\n"
+        "\t<g bimpp=\"{'type':'node','id':92,'x':0,'y':0}\">\n"
+        "\t\t<circle cx=\"1\" cy=\"1\" r=\"1\" bimpp=\"{'type':'node','id':93,'x':1,'y':1}\" />\n"
+        "\t\t<g><line x1=\"0\" y1=\"0\" x2=\"1\" y2=\"1\" bimpp=\"{'type':'wall','id':94,'start-node-id':0,'end-node-id':1,'thickness':1}\" /></g>\n"
+        "\t</g>\n"
+        "\t<g />\n"
+        "\t<rect x=\"0\" y=\"0\" width=\"1\" height=\"1\" bimpp=\"{'type':'node','id':95,'x':0,'y':0}\" />\n"
+        "\t<circle cx=\"0\" cy=\"0\" r=\"1\" bimpp=\"{'type':'node','id':0,'x':0,'y':0}\" />\n"
+        "\t<circle cx=\"1\" cy=\"0\" r=\"1\" bimpp=\"{'type':'node','id':1,'x':1,'y':0}\"></circle>\n"
+        "\t<line x1=\"0\" y1=\"0\" x2=\"1\" y2=\"0\" bimpp=\"{'type':'wall','id':0,'start-node-id':0,'end-node-id':1,'thickness':1}\" />\n"
+        "\t<path d=\"M0,0 L1,0 z\" bimpp=\"{'type':'room','id':0,'wall-ids':[0]}\" />\n"
+        "</svg>\n";
+}
+
+// check_stream [plan.svg ...]
+// the houses of `stream` and `reload` are compared with the house of `load`, it exits with 1 if one differs.
+int main(int argc, char* argv[])
+{
+    checkSvg("decoys", decoy_svg);
+    std::string svg_context = decoy_svg;
+    house_type bim_house;
+    std::string error_message;
+    loader_type::load(svg_context, bim_house, error_message);
+    expect(bim_house.nodes.size() == 2 && bim_house.walls.size() == 1 && bim_house.rooms.size() == 1 && bim_house.nodes.at(0).x == 0,
+        "decoys: a decoy is loaded");
+
+    std::vector<std::string> paths(argv + 1, argv + argc);
+    if (paths.empty())
+    {
+        paths.push_back(BIMPP_SVGEX_SAMPLE_PLAN);
+    }
+    for (const std::string& path : paths)
+    {
+        std::string svg;
+        if (!bimpp::svgex::read_file(path, svg))
+        {
+            expect(false, path + ": can not be read");
+            continue;
+        }
+        checkSvg(path, svg);
+    }
+    std::cout << paths.size() + 1 << " plans, " << failure_count << " failed" << std::endl;
+    return failure_count == 0 ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "plan_generator.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+// generate_plan <element-count> [output.svg]
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: generate_plan <element-count> [output.svg]" << std::endl;
+        return 1;
+    }
+    const size_t element_count = static_cast<size_t>(std::strtoull(argv[1], nullptr, 10));
+    std::string svg;
+    const bimpp::svgex::bench::plan_counts counts = bimpp::svgex::bench::plan_generator().generateElements(element_count, svg);
+    if (argc > 2)
+    {
+        std::ofstream svg_ofs(argv[2], std::ofstream::out | std::ofstream::binary);
+        svg_ofs.write(svg.data(), static_cast<std::streamsize>(svg.size()));
+        if (!svg_ofs)
+        {
+            std::cerr << "can not write " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout.write(svg.data(), static_cast<std::streamsize>(svg.size()));
+    }
+    std::cerr << counts.node_count << " nodes, " << counts.wall_count << " walls, "
+        << counts.hole_count << " holes, " << counts.room_count << " rooms, " << svg.size() << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <cmath>
+#include <cstdio>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        namespace bench
+        {
+            struct plan_counts
+            {
+                size_t node_count = 0;
+                size_t wall_count = 0;
+                size_t hole_count = 0;
+                size_t room_count = 0;
+
+                size_t getElementCount() const
+                {
+                    return node_count + wall_count + hole_count + room_count;
+                }
+            };
+
+            // a grid of square rooms in the `bimpp` attribute format of the samples.
+            // every room has its 4 walls and a door in its bottom wall, the walls are shared by the neighbours,
+            // so a plan has about 5 elements per room.
+            class plan_generator
+            {
+            public:
+                explicit plan_generator(double _cell_size = 300.0, double _wall_thickness = 8.0)
+                    : cell_size(_cell_size)
+                    , wall_thickness(_wall_thickness)
+                {}
+
+                // the plan with about `_element_count` elements.
+                plan_counts generateElements(size_t _element_count, std::string& _svg) const
+                {
+                    return generateRooms(_element_count / 5 > 0 ? _element_count / 5 : 1, _svg);
+                }
+
+                plan_counts generateRooms(size_t _room_count, std::string& _svg) const
+                {
+                    const size_t column_count = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(_room_count))));
+                    const size_t row_count = (_room_count + column_count - 1) / column_count;
+                    // the full rows of nodes and walls are emitted, the rooms of the last row may be fewer.
+                    const size_t node_column_count = column_count + 1;
+                    const size_t horizontal_wall_count = column_count * (row_count + 1);
+
+                    plan_counts counts;
+                    _svg.clear();
+                    _svg.reserve(_room_count * 1024);
+                    _svg += "<?xml version=\"1.0\" standalone=\"no\" ?>\n";
+                    append(_svg, "<svg width=\"%gpx\" height=\"%gpx\" xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" >\n",
+                        column_count * cell_size, row_count * cell_size);
+
+                    for (size_t row = 0; row < row_count; ++row)
+                    {
+                        for (size_t column = 0; column < column_count && counts.room_count < _room_count; ++column)
+                        {
+                            const double x0 = column * cell_size;
+                            const double y0 = row * cell_size;
+                            const size_t top_wall_id = row * column_count + column;
+                            const size_t bottom_wall_id = top_wall_id + column_count;
+                            const size_t left_wall_id = horizontal_wall_count + row * node_column_count + column;
+                            append(_svg, "\t<path d=\"M%g,%g %g,%g %g,%g %g,%g z \" fill-rule=\"evenodd\" fill=\"rgb(192,192,192)\" "
+                                "bimpp=\"{'type':'room','id':%zu,'wall-ids':[%zu,%zu,%zu,%zu],'kind':'unknown'}\" />\n",
+                                x0, y0, x0 + cell_size, y0, x0 + cell_size, y0 + cell_size, x0, y0 + cell_size,
+                                counts.room_count, top_wall_id, left_wall_id + 1, bottom_wall_id, left_wall_id);
+                            ++counts.room_count;
+                        }
+                    }
+
+                    for (size_t row = 0; row <= row_count; ++row)
+                    {
+                        for (size_t column = 0; column < column_count; ++column)
+                        {
+                            const size_t start_node_id = row * node_column_count + column;
+                            appendWall(_svg, counts.wall_count, start_node_id, start_node_id + 1,
+                                column * cell_size, row * cell_size, (column + 1) * cell_size, row * cell_size);
+                            ++counts.wall_count;
+                        }
+                    }
+                    for (size_t row = 0; row < row_count; ++row)
+                    {
+                        for (size_t column = 0; column <= column_count; ++column)
+                        {
+                            const size_t start_node_id = row * node_column_count + column;
+                            appendWall(_svg, counts.wall_count, start_node_id, start_node_id + node_column_count,
+                                column * cell_size, row * cell_size, column * cell_size, (row + 1) * cell_size);
+                            ++counts.wall_count;
+                        }
+                    }
+
+                    for (; counts.hole_count < counts.room_count; ++counts.hole_count)
+                    {
+                        const size_t wall_id = counts.hole_count + column_count;
+                        const double x = (wall_id % column_count) * cell_size + cell_size / 3;
+                        const double y = (wall_id / column_count) * cell_size;
+                        append(_svg, "\t<line x1=\"%g\" y1=\"%g\" x2=\"%g\" y2=\"%g\" stroke-width=\"%g\" stroke=\"rgb(0,128,0)\" "
+                            "bimpp=\"{'type':'hole','id':%zu,'kind':'door','direction':'right','wall-id':%zu,'width':%g,'distance':%g}\" />\n",
+                            x, y, x + cell_size / 4, y, wall_thickness, counts.hole_count, wall_id, cell_size / 4, cell_size / 3);
+                    }
+
+                    for (size_t row = 0; row <= row_count; ++row)
+                    {
+                        for (size_t column = 0; column <= column_count; ++column)
+                        {
+                            const double x = column * cell_size;
+                            const double y = row * cell_size;
+                            append(_svg, "\t<circle cx=\"%g\" cy=\"%g\" r=\"0.5\" fill=\"rgb(255,0,0)\" stroke-width=\"2\" stroke=\"rgb(255,0,0)\" "
+                                "bimpp=\"{'type':'node','id':%zu,'x':%g,'y':%g}\" />\n",
+                                x, y, counts.node_count, x, y);
+                            ++counts.node_count;
+                        }
+                    }
+                    _svg += "</svg>\n";
+                    return counts;
+                }
+
+            private:
+                void appendWall(std::string& _svg, size_t _id, size_t _start_node_id, size_t _end_node_id,
+                    double _x1, double _y1, double _x2, double _y2) const
+                {
+                    append(_svg, "\t<line x1=\"%g\" y1=\"%g\" x2=\"%g\" y2=\"%g\" stroke-width=\"%g\" stroke=\"rgb(0,0,0)\" "
+                        "bimpp=\"{'type':'wall','id':%zu,'start-node-id':%zu,'end-node-id':%zu,'thickness':%g}\" />\n",
+                        _x1, _y1, _x2, _y2, wall_thickness, _id, _start_node_id, _end_node_id, wall_thickness);
+                }
+
+                template<typename... TArgs>
+                static void append(std::string& _svg, const char* _format, TArgs... _args)
+                {
+                    char line[512];
+                    const int line_size = std::snprintf(line, sizeof(line), _format, _args...);
+                    _svg.append(line, static_cast<size_t>(line_size));
+                }
+
+            private:
+                double  cell_size;
+                double  wall_thickness;
+            };
+        }
+    }
+}
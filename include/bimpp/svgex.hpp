@@ -24,14 +24,43 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <array>
 #include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <memory>
+#include <istream>
+#include <chrono>
+#include <thread>
 
+#include <boost/optional.hpp>
+#include <boost/range/begin.hpp>
+#include <boost/range/end.hpp>
+#include <boost/mpl/set.hpp>
 #include <rapidxml_ns.hpp>
 #include <svgpp/svgpp.hpp>
 #include <svgpp/policy/xml/rapidxml_ns.hpp>
 #include <rapidjson/document.h>
 #include <bimpp/plan2d.hpp>
+#include <bimpp/svgex/flat_house.hpp>
+#include <bimpp/svgex/file.hpp>
+#include <bimpp/svgex/work_stealing.hpp>
+#include <bimpp/svgex/scanner.hpp>
+#include <bimpp/svgex/validator.hpp>
+#include <bimpp/svgex/outline.hpp>
+#include <bimpp/svgex/profile.hpp>
+#include <bimpp/svgex/incremental.hpp>
+#include <bimpp/svgex/cache.hpp>
+#include <bimpp/svgex/writer.hpp>
+#include <bimpp/svgex/stats.hpp>
+#include <bimpp/svgex/diagnostics.hpp>
+#include <bimpp/svgex/spatial_index.hpp>
+#include <bimpp/svgex/protocol.hpp>
 
 #ifndef M_PI
 #define M_PI       3.14159265358979323846   // pi
@@ -41,7 +70,10 @@ namespace bimpp
 {
     namespace svgex
     {
-        template<typename TConstant = plan2d::constant<>>
+        // `TProfile` is one of `profile::metadata`, `profile::metadata_geometry` and `profile::full`,
+        // the outlines of the rooms can only be loaded to a `room_outlines` if the profile decodes the geometry.
+        // the default `profile::full` checks every attribute as svgpp always did, the others are opt-in.
+        template<typename TConstant = plan2d::constant<>, typename TProfile = profile::full>
         class loader
         {
         public:
@@ -59,106 +91,500 @@ namespace bimpp
             typedef typename std::map<size_t, room_type>    room_map;
             typedef typename std::pair<size_t, room_type>   room_pair;
             typedef typename plan2d::house<TConstant>       house_type;
+            typedef flat_house<TConstant>                   flat_house_type;
+            typedef validator<TConstant>                    validator_type;
+            typedef room_outlines<TConstant>                room_outlines_type;
+            typedef house_cache<TConstant>                  house_cache_type;
+            typedef svg_writer<TConstant>                   svg_writer_type;
+            typedef spatial_index<TConstant>                spatial_index_type;
 
         private:
+            typedef rapidjson::MemoryPoolAllocator<>    json_allocator_type;
+            typedef rapidjson::GenericDocument<rapidjson::UTF8<>, json_allocator_type, json_allocator_type> json_document_type;
+
+        public:
+            // the parser state which is reused between the loadings, one for each thread.
+            class workspace
+            {
+            public:
+                workspace()
+                    : validation_thread_count(0)
+                    , json_allocator(&json_buffer, sizeof(json_buffer))
+                    , json_doc(&json_allocator, json_stack_capacity, &json_allocator)
+                {}
+
+                // the threads of the validation, all the cores are used if it is 0.
+                size_t validation_thread_count;
+
+            private:
+                friend class loader;
+
+                static const size_t json_buffer_size = 16 * 1024;
+                static const size_t json_stack_capacity = 1024;
+
+                rapidxml_ns::xml_document<> xml_doc;
+                typename std::aligned_storage<json_buffer_size>::type json_buffer;
+                json_allocator_type         json_allocator;
+                json_document_type          json_doc;
+            };
+
+            struct batch_result
+            {
+                batch_result()
+                    : success(false)
+                    , bytes(0)
+                    , seconds(0.0)
+                {}
+
+                std::string path;
+                bool        success;
+                house_type  house;
+                std::string error;
+                size_t      bytes;
+                double      seconds;
+            };
+
+            struct batch_summary
+            {
+                batch_summary()
+                    : file_count(0)
+                    , failed_count(0)
+                    , thread_count(0)
+                    , bytes(0)
+                    , seconds(0.0)
+                {}
+
+                size_t  file_count;
+                size_t  failed_count;
+                size_t  thread_count;
+                size_t  bytes;
+                double  seconds;
+            };
+
+            // the content hashes of the elements of the previous `reload` and the index of its house, keep one for each edited house.
+            class incremental_state
+            {
+            public:
+                incremental_state()
+                    : generation(0)
+                {}
+
+                // the next `reload` loads the whole house again.
+                void reset()
+                {
+                    elements.clear();
+                    index.clear();
+                    generation = 0;
+                }
+
+                size_t size() const
+                {
+                    return elements.size();
+                }
+
+                // the index of the house of the last `reload`, for `collectAffectedRooms`.
+                const house_index& getIndex() const
+                {
+                    return index;
+                }
+
+            private:
+                friend class loader;
+
+                std::unordered_map<uint64_t, element_record>    elements;
+                house_index                                     index;
+                size_t                                          generation;
+                workspace                                       bim_workspace;
+            };
+
+        private:
+
+            // the storage of the std::map based house.
+            class BimPPMapStorage
+            {
+            public:
+                bool addNode(size_t _id, precision_type _x, precision_type _y)
+                {
+                    return all_nodes.insert(std::make_pair<>(_id, node_type(_x, _y))).second;
+                }
+
+                bool addWall(size_t _id, wall_type&& _wall)
+                {
+                    return all_walls.insert(std::make_pair<>(_id, std::move(_wall))).second;
+                }
+
+                bool addHole(size_t _id, hole_type&& _hole)
+                {
+                    return all_holes.insert(std::make_pair<>(_id, std::move(_hole))).second;
+                }
+
+                bool addRoom(size_t _id, room_type&& _room)
+                {
+                    return all_rooms.insert(std::make_pair<>(_id, std::move(_room))).second;
+                }
+
+                bool validate(validation_report& _report, size_t _thread_count) const
+                {
+                    return validator_type::validate(all_nodes, all_walls, all_holes, all_rooms, _report, _thread_count);
+                }
+
+                // the maps are moved to `_house`, the storage is empty after that.
+                void moveTo(house_type& _house)
+                {
+                    _house.reset();
+                    _house.nodes = std::move(all_nodes);
+                    _house.walls = std::move(all_walls);
+                    _house.holes = std::move(all_holes);
+                    _house.rooms = std::move(all_rooms);
+                    all_nodes.clear();
+                    all_walls.clear();
+                    all_holes.clear();
+                    all_rooms.clear();
+                }
+
+            private:
+                node_map    all_nodes;
+                wall_map    all_walls;
+                hole_map    all_holes;
+                room_map    all_rooms;
+            };
+
+            // the entities of the new elements of a `reload`, in the order of the document.
+            class BimPPDeltaStorage
+            {
+            public:
+                template<typename TEntity>
+                struct pending
+                {
+                    size_t      id;
+                    TEntity     entity;
+                };
+
+                BimPPDeltaStorage()
+                    : has_last(false)
+                    , last_type(entity_type::node)
+                    , last_id(0)
+                {}
+
+                bool addNode(size_t _id, precision_type _x, precision_type _y)
+                {
+                    nodes.push_back(pending<node_type>{ _id, node_type(_x, _y) });
+                    return setLast(entity_type::node, _id);
+                }
+
+                bool addWall(size_t _id, wall_type&& _wall)
+                {
+                    walls.push_back(pending<wall_type>{ _id, std::move(_wall) });
+                    return setLast(entity_type::wall, _id);
+                }
+
+                bool addHole(size_t _id, hole_type&& _hole)
+                {
+                    holes.push_back(pending<hole_type>{ _id, std::move(_hole) });
+                    return setLast(entity_type::hole, _id);
+                }
+
+                bool addRoom(size_t _id, room_type&& _room)
+                {
+                    rooms.push_back(pending<room_type>{ _id, std::move(_room) });
+                    return setLast(entity_type::room, _id);
+                }
+
+                // the entity decoded from the last element, if any.
+                void takeLast(element_record& _record)
+                {
+                    _record.has_entity = has_last;
+                    _record.type = last_type;
+                    _record.id = last_id;
+                    has_last = false;
+                }
+
+            private:
+                bool setLast(entity_type _type, size_t _id)
+                {
+                    has_last = true;
+                    last_type = _type;
+                    last_id = _id;
+                    return true;
+                }
+
+            public:
+                std::vector<pending<node_type>>     nodes;
+                std::vector<pending<wall_type>>     walls;
+                std::vector<pending<hole_type>>     holes;
+                std::vector<pending<room_type>>     rooms;
+
+            private:
+                bool                                has_last;
+                entity_type                         last_type;
+                size_t                              last_id;
+            };
+
+            // `TStorage` receives the entities, see `BimPPMapStorage` and `flat_house`.
+            // `TStats` is `load_stats`, or `null_stats` to compile the statistics out.
+            template<typename TStorage, typename TStats = null_stats>
             class BimPPContext
             {
             public:
-                void on_enter_element(svgpp::tag::element::any _any) {}
+                typedef TStats stats_type;
+
+                BimPPContext(TStorage& _storage, json_document_type& _json_doc, json_allocator_type& _json_allocator, TStats& _stats,
+                    room_outlines_type* _outlines = nullptr)
+                    : storage(_storage)
+                    , current_bimpp(nullptr)
+                    , element_depth(0)
+                    , json_doc(_json_doc)
+                    , json_allocator(_json_allocator)
+                    , stats(_stats)
+                    , outlines(_outlines)
+                {
+                    if (outlines != nullptr)
+                    {
+                        outline.setTolerance(outlines->tolerance);
+                    }
+                }
+
+                void on_enter_element(svgpp::tag::element::any _any)
+                {
+                    ++element_depth;
+                    outline.clear();
+                }
 
                 void on_exit_element()
                 {
-                    if (current_bimpp.empty())
+                    stats.onElement();
+                    if (current_bimpp != nullptr)
+                    {
+                        typename TStats::phase_scope scope(stats, load_phase::json_decode);
+                        decodeBimPP();
+                    }
+                    outline.clear();
+                    if (element_depth > 0)
+                    {
+                        --element_depth;
+                    }
+                }
+
+                // `_value` points into the xml buffer and is terminated by rapidxml,
+                // it is rewritten and parsed in place without any copy.
+                // the `bimpp` attribute of the root svg is not an entity, as in `bimpp_scanner`.
+                void on_bimpp(char* _value, size_t _size)
+                {
+                    if (element_depth == 1)
+                    {
+                        return;
+                    }
+                    // use `"` to replace `'`
+                    std::replace(_value, _value + _size, '\'', '\"');
+                    current_bimpp = _value;
+                    stats.onBimPP();
+                }
+
+                // only called by the lenient loading, the attribute is skipped.
+                void on_unknown_attribute(const char* _name, size_t _name_size)
+                {
+                    stats.onUnknownAttribute(_name, _name_size);
+                }
+
+                void on_unknown_css_property(const char* _location)
+                {
+                    stats.onUnknownCssProperty(_location);
+                }
+
+                void on_unknown_element(const char* _name, size_t _name_size)
+                {
+                    stats.onUnknownElement(_name, _name_size);
+                }
+
+                void on_invalid_value(const char* _detail, size_t _detail_size, const char* _location)
+                {
+                    stats.onInvalidValue(_detail, _detail_size, _location);
+                }
+
+                // the path callbacks are only called if the geometry is decoded.
+                void path_move_to(double x, double y, svgpp::tag::coordinate::absolute)
+                {
+                    if (outlines != nullptr)
+                    {
+                        outline.moveTo(x, y);
+                    }
+                }
+
+                void path_line_to(double x, double y, svgpp::tag::coordinate::absolute)
+                {
+                    if (outlines != nullptr)
+                    {
+                        outline.lineTo(x, y);
+                    }
+                }
+
+                void path_cubic_bezier_to(
+                    double x1, double y1,
+                    double x2, double y2,
+                    double x, double y,
+                    svgpp::tag::coordinate::absolute)
+                {
+                    if (outlines != nullptr)
+                    {
+                        outline.cubicTo(x1, y1, x2, y2, x, y);
+                    }
+                }
+
+                void path_quadratic_bezier_to(
+                    double x1, double y1,
+                    double x, double y,
+                    svgpp::tag::coordinate::absolute)
+                {
+                    if (outlines != nullptr)
+                    {
+                        outline.quadraticTo(x1, y1, x, y);
+                    }
+                }
+
+                void path_elliptical_arc_to(
+                    double rx, double ry, double x_axis_rotation,
+                    bool large_arc_flag, bool sweep_flag,
+                    double x, double y,
+                    svgpp::tag::coordinate::absolute)
+                {
+                    if (outlines != nullptr)
+                    {
+                        outline.arcTo(rx, ry, x_axis_rotation, large_arc_flag, sweep_flag, x, y);
+                    }
+                }
+
+                void path_close_subpath()
+                {
+                    if (outlines != nullptr)
+                    {
+                        outline.closeSubpath();
+                    }
+                }
+
+                void path_exit()
+                {
+                    if (outlines != nullptr)
+                    {
+                        outline.finish();
+                    }
+                }
+
+            private:
+                void decodeBimPP()
+                {
+                    if (current_bimpp == nullptr)
                     {
                         return;
                     }
 
-                    const std::string bimpp_data = current_bimpp;
-                    current_bimpp.clear();
+                    char* bimpp_data = current_bimpp;
+                    current_bimpp = nullptr;
 
-                    rapidjson::Document json_doc;
-                    json_doc.Parse(bimpp_data.c_str());
-                    if (!json_doc.HasMember("type")
-                        || !json_doc.HasMember("id"))
+                    // the values of the previous element are dropped here,
+                    // so that the pool keeps reusing its first chunk.
+                    json_doc.SetNull();
+                    json_allocator.Clear();
+                    // the numbers of 17 significant digits of `svg_writer` only read back exactly in full precision,
+                    // the short ones still take the fast path.
+                    json_doc.ParseInsitu<rapidjson::kParseFullPrecisionFlag>(bimpp_data);
+                    if (json_doc.HasParseError())
+                    {
+                        stats.onRejected(rejection_reason::json_syntax, bimpp_data);
+                        return;
+                    }
+                    if (!json_doc.IsObject())
                     {
+                        stats.onRejected(rejection_reason::not_object, bimpp_data);
                         return;
                     }
-                    const rapidjson::Value& json_type = json_doc["type"];
-                    const rapidjson::Value& json_id = json_doc["id"];
-                    if (!json_type.IsString()
-                        || !json_id.IsUint64())
+                    const rapidjson::Value* json_type = findMember(json_doc, "type");
+                    const rapidjson::Value* json_id = findMember(json_doc, "id");
+                    if (json_type == nullptr
+                        || json_id == nullptr
+                        || !json_type->IsString()
+                        || !json_id->IsUint64())
                     {
+                        stats.onRejected(rejection_reason::missing_key, bimpp_data);
                         return;
                     }
-                    const size_t bim_id = json_id.GetUint64();
-                    if (json_type == "node")
+                    const size_t bim_id = json_id->GetUint64();
+                    if (*json_type == "node")
                     {
-                        if (!json_doc.HasMember("x")
-                            || !json_doc.HasMember("y"))
+                        const rapidjson::Value* json_x = findMember(json_doc, "x");
+                        const rapidjson::Value* json_y = findMember(json_doc, "y");
+                        if (json_x == nullptr
+                            || json_y == nullptr
+                            || !json_x->IsNumber()
+                            || !json_y->IsNumber())
                         {
+                            stats.onRejected(rejection_reason::invalid_node, bimpp_data);
                             return;
                         }
-                        node_type new_node(static_cast<precision_type>(json_doc["x"].GetDouble()), static_cast<precision_type>(json_doc["y"].GetDouble()));
-                        all_nodes.insert(std::make_pair<>(bim_id, new_node));
+                        addEntity(entity_type::node, storage.addNode(bim_id, static_cast<precision_type>(json_x->GetDouble()), static_cast<precision_type>(json_y->GetDouble())), bimpp_data);
                     }
-                    else if (json_type == "wall")
+                    else if (*json_type == "wall")
                     {
-                        if (!json_doc.HasMember("start-node-id")
-                            || !json_doc.HasMember("end-node-id")
-                            || !json_doc.HasMember("thickness"))
+                        const rapidjson::Value* json_start_node_id = findMember(json_doc, "start-node-id");
+                        const rapidjson::Value* json_end_node_id = findMember(json_doc, "end-node-id");
+                        const rapidjson::Value* json_thickness = findMember(json_doc, "thickness");
+                        if (json_start_node_id == nullptr
+                            || json_end_node_id == nullptr
+                            || json_thickness == nullptr
+                            || !json_start_node_id->IsUint64()
+                            || !json_end_node_id->IsUint64()
+                            || !json_thickness->IsNumber())
                         {
+                            stats.onRejected(rejection_reason::invalid_wall, bimpp_data);
                             return;
                         }
                         wall_type new_wall;
-                        if (json_doc.HasMember("kind"))
-                        {
-                            new_wall.kind = json_doc["kind"].GetString();
-                        }
-                        new_wall.start_node_id = json_doc["start-node-id"].GetUint64();
-                        new_wall.end_node_id = json_doc["end-node-id"].GetUint64();
-                        new_wall.thickness = json_doc["thickness"].GetDouble();
-                        all_walls.insert(std::make_pair<>(bim_id, new_wall));
+                        getString(json_doc, "kind", new_wall.kind);
+                        new_wall.start_node_id = json_start_node_id->GetUint64();
+                        new_wall.end_node_id = json_end_node_id->GetUint64();
+                        new_wall.thickness = json_thickness->GetDouble();
+                        addEntity(entity_type::wall, storage.addWall(bim_id, std::move(new_wall)), bimpp_data);
                     }
-                    else if (json_type == "hole")
+                    else if (*json_type == "hole")
                     {
-                        if (!json_doc.HasMember("wall-id")
-                            || !json_doc.HasMember("distance")
-                            || !json_doc.HasMember("width"))
+                        const rapidjson::Value* json_wall_id = findMember(json_doc, "wall-id");
+                        const rapidjson::Value* json_distance = findMember(json_doc, "distance");
+                        const rapidjson::Value* json_width = findMember(json_doc, "width");
+                        if (json_wall_id == nullptr
+                            || json_distance == nullptr
+                            || json_width == nullptr
+                            || !json_wall_id->IsUint64()
+                            || !json_distance->IsNumber()
+                            || !json_width->IsNumber())
                         {
+                            stats.onRejected(rejection_reason::invalid_hole, bimpp_data);
                             return;
                         }
                         hole_type new_hole;
-                        if (json_doc.HasMember("kind"))
-                        {
-                            new_hole.kind = json_doc["kind"].GetString();
-                        }
-                        if (json_doc.HasMember("direction"))
-                        {
-                            new_hole.direction = json_doc["direction"].GetString();
-                        }
-                        new_hole.wall_id = json_doc["wall-id"].GetUint64();
-                        new_hole.distance = json_doc["distance"].GetDouble();
-                        new_hole.width = json_doc["width"].GetDouble();
-                        all_holes.insert(std::make_pair<>(bim_id, new_hole));
+                        getString(json_doc, "kind", new_hole.kind);
+                        getString(json_doc, "direction", new_hole.direction);
+                        new_hole.wall_id = json_wall_id->GetUint64();
+                        new_hole.distance = json_distance->GetDouble();
+                        new_hole.width = json_width->GetDouble();
+                        addEntity(entity_type::hole, storage.addHole(bim_id, std::move(new_hole)), bimpp_data);
                     }
-                    else if (json_type == "room")
+                    else if (*json_type == "room")
                     {
-                        if (!json_doc.HasMember("wall-ids"))
-                        {
-                            return;
-                        }
-                        const rapidjson::Value& json_wall_ids = json_doc["wall-ids"];
-                        if (!json_wall_ids.IsArray())
+                        const rapidjson::Value* json_wall_ids = findMember(json_doc, "wall-ids");
+                        if (json_wall_ids == nullptr
+                            || !json_wall_ids->IsArray())
                         {
+                            stats.onRejected(rejection_reason::invalid_room, bimpp_data);
                             return;
                         }
                         room_type new_room;
-                        if (json_doc.HasMember("kind"))
-                        {
-                            new_room.kind = json_doc["kind"].GetString();
-                        }
-                        for (rapidjson::Value::ConstValueIterator itr = json_wall_ids.Begin(); itr != json_wall_ids.End(); ++itr)
+                        getString(json_doc, "kind", new_room.kind);
+                        new_room.wall_ids.reserve(json_wall_ids->Size());
+                        for (rapidjson::Value::ConstValueIterator itr = json_wall_ids->Begin(); itr != json_wall_ids->End(); ++itr)
                         {
+                            if (!itr->IsUint64())
+                            {
+                                continue;
+                            }
                             const size_t bim_wall_id = itr->GetUint64();
                             // remove the repeated wall.
                             if (std::find(new_room.wall_ids.cbegin(), new_room.wall_ids.cend(), bim_wall_id) != new_room.wall_ids.cend())
@@ -169,184 +595,246 @@ namespace bimpp
                         }
                         if (new_room.wall_ids.empty())
                         {
+                            stats.onRejected(rejection_reason::invalid_room, bimpp_data);
                             return;
                         }
-                        all_rooms.insert(std::make_pair<>(bim_id, new_room));
+                        if (addEntity(entity_type::room, storage.addRoom(bim_id, std::move(new_room)), bimpp_data)
+                            && outlines != nullptr
+                            && outline.getRingCount() > 0)
+                        {
+                            outlines->addRoom(bim_id, outline.getPoints(), outline.getRingEnds(), outline.getRingCount());
+                        }
+                    }
+                    else
+                    {
+                        stats.onRejected(rejection_reason::unknown_type, bimpp_data);
                     }
                 }
 
-                void on_bimpp(const std::string& _value)
+                bool addEntity(entity_type _type, bool _added, const char* _bimpp)
                 {
-                    current_bimpp = _value;
-                    // use `"` to replace `'`
-                    for (char& c : current_bimpp)
+                    if (!_added)
                     {
-                        if (c != '\'') continue;
-                        c = '\"';
+                        stats.onRejected(rejection_reason::repeated_id, _bimpp);
+                        return false;
                     }
+                    stats.onEntity(_type);
+                    return true;
                 }
 
-                void path_move_to(double x, double y, svgpp::tag::coordinate::absolute) {}
+                static const rapidjson::Value* findMember(const rapidjson::Value& _object, const char* _name)
+                {
+                    rapidjson::Value::ConstMemberIterator itr = _object.FindMember(_name);
+                    return itr != _object.MemberEnd() ? &itr->value : nullptr;
+                }
 
-                void path_line_to(double x, double y, svgpp::tag::coordinate::absolute) {}
+                static void getString(const rapidjson::Value& _object, const char* _name, std::string& _value)
+                {
+                    const rapidjson::Value* json_value = findMember(_object, _name);
+                    if (json_value != nullptr
+                        && json_value->IsString())
+                    {
+                        _value.assign(json_value->GetString(), json_value->GetStringLength());
+                    }
+                }
 
-                void path_cubic_bezier_to(
-                    double x1, double y1,
-                    double x2, double y2,
-                    double x, double y,
-                    svgpp::tag::coordinate::absolute)
-                {}
+            private:
+                TStorage&               storage;
+                char*                   current_bimpp;
+                size_t                  element_depth;  // 1 in the root svg, 0 if the elements are not entered, e.g. by `stream`
+                json_document_type&     json_doc;
+                json_allocator_type&    json_allocator;
+                TStats&                 stats;
+                room_outlines_type*     outlines;
+                outline_builder<TConstant> outline;
+            };
 
-                void path_quadratic_bezier_to(
-                    double x1, double y1,
-                    double x, double y,
-                    svgpp::tag::coordinate::absolute)
-                {}
+            typedef rapidxml_ns::xml_node<> const* xml_element_t;
 
-                void path_elliptical_arc_to(
-                    double rx, double ry, double x_axis_rotation,
-                    bool large_arc_flag, bool sweep_flag,
-                    double x, double y,
-                    svgpp::tag::coordinate::absolute)
-                {}
+            // the errors of svgpp throw, unless the stats of the context are lenient,
+            // then they are recorded and the element or the attribute is skipped.
+            template<typename TContext>
+            struct BimPPErrorPolicy : svgpp::policy::error::raise_exception<TContext>
+            {
+                typedef svgpp::policy::error::raise_exception<TContext> base_type;
 
-                void path_close_subpath() {}
+                // the text of an attribute value, if svgpp passes it as a range of the svg.
+                template<class AttributeValue>
+                static void onInvalidValue(TContext& _context, AttributeValue const& _value,
+                    typename boost::enable_if<typename svgpp::detail::is_char_range<AttributeValue>::type>::type* = NULL)
+                {
+                    const size_t value_size = static_cast<size_t>(boost::end(_value) - boost::begin(_value));
+                    if (value_size == 0)
+                    {
+                        _context.on_invalid_value("", 0, nullptr);
+                        return;
+                    }
+                    const char* value_begin = &*boost::begin(_value);
+                    _context.on_invalid_value(value_begin, value_size, value_begin);
+                }
 
-                void path_exit() {}
+                template<class AttributeValue>
+                static void onInvalidValue(TContext& _context, AttributeValue const&,
+                    typename boost::disable_if<typename svgpp::detail::is_char_range<AttributeValue>::type>::type* = NULL)
+                {
+                    static const char detail[] = "out of range";
+                    _context.on_invalid_value(detail, sizeof(detail) - 1, nullptr);
+                }
+                template<class XMLAttribute>
+                static bool isBimPPAttribute(XMLAttribute const& _attribute)
+                {
+                    static const char bimpp_name[] = "bimpp";
+                    return _attribute->name_size() == sizeof(bimpp_name) - 1
+                        && std::memcmp(_attribute->name(), bimpp_name, sizeof(bimpp_name) - 1) == 0;
+                }
 
-                bool getHouse(house_type& _house, bool _check = false)
+                template<class XMLAttribute, class AttributeName>
+                static bool unknown_attribute(TContext& _context,
+                    XMLAttribute const& _attribute,
+                    AttributeName const& name,
+                    BOOST_SCOPED_ENUM(svgpp::detail::namespace_id) namespace_id,
+                    svgpp::tag::source::attribute,
+                    typename boost::enable_if<typename svgpp::detail::is_char_range<AttributeName>::type>::type* = NULL)
                 {
-                    if (_check)
+                    if (isBimPPAttribute(_attribute))
                     {
-                        for (const std::pair<size_t, wall_type>& p_wall : all_walls)
-                        {
-                            const wall_type& bim_wall = p_wall.second;
-                            if (!bim_wall.isValid())
-                            {
-                                return false;
-                            }
-                            if (all_nodes.find(bim_wall.start_node_id) == all_nodes.cend())
-                            {
-                                return false;
-                            }
-                            if (all_nodes.find(bim_wall.end_node_id) == all_nodes.cend())
-                            {
-                                return false;
-                            }
-                        }
-
-                        for (const std::pair<size_t, hole_type>& p_hole : all_holes)
-                        {
-                            const hole_type& bim_hole = p_hole.second;
-                            if (!bim_hole.isValid())
-                            {
-                                return false;
-                            }
-                            if (all_walls.find(bim_hole.wall_id) == all_walls.cend())
-                            {
-                                return false;
-                            }
-                        }
-
-                        for (const std::pair<size_t, room_type>& p_room : all_rooms)
-                        {
-                            const room_type& bim_room = p_room.second;
-                            if (bim_room.wall_ids.empty())
-                            {
-                                return false;
-                            }
-                            for (size_t wall_id : bim_room.wall_ids)
-                            {
-                                if (all_walls.find(wall_id) == all_walls.cend())
-                                {
-                                    return false;
-                                }
-                            }
-                        }
+                        _context.on_bimpp(_attribute->value(), _attribute->value_size());
+                        return true;
                     }
-
-                    _house.reset();
-                    _house.nodes = all_nodes;
-                    _house.walls = all_walls;
-                    _house.holes = all_holes;
-                    _house.rooms = all_rooms;
-                    return true;
-                }
-
-            private:
-                std::string current_bimpp;
-                node_map    all_nodes;
-                wall_map    all_walls;
-                hole_map    all_holes;
-                room_map    all_rooms;
-            };
-
-            typedef rapidxml_ns::xml_node<> const* xml_element_t;
-
-            struct BimPPErrorPolicy : svgpp::policy::error::raise_exception<BimPPContext>
-            {
-                template<class XMLAttribute, class AttributeName>
-                static bool unknown_attribute(BimPPContext& _context,
-                    XMLAttribute const& _attribute,
-                    AttributeName const& name,
-                    BOOST_SCOPED_ENUM(svgpp::detail::namespace_id) namespace_id,
-                    svgpp::tag::source::attribute,
-                    typename boost::enable_if<typename svgpp::detail::is_char_range<AttributeName>::type>::type* = NULL)
-                {
-                    const std::string attribute_name = _attribute->name();
-                    if (attribute_name == "bimpp")
+                    if (namespace_id != svgpp::detail::namespace_id::svg)
                     {
-                        const std::string attribute_value = _attribute->value();
-                        _context.on_bimpp(attribute_value);
                         return true;
                     }
-                    if (namespace_id == svgpp::detail::namespace_id::svg)
-                        throw svgpp::unknown_attribute_error(name) << boost::error_info<svgpp::tag::error_info::xml_attribute, XMLAttribute>(_attribute);
-                    else
+                    if (TContext::stats_type::lenient)
+                    {
+                        _context.on_unknown_attribute(_attribute->name(), _attribute->name_size());
                         return true;
+                    }
+                    throw svgpp::unknown_attribute_error(name) << boost::error_info<svgpp::tag::error_info::xml_attribute, XMLAttribute>(_attribute);
                 }
 
                 template<class XMLAttribute, class AttributeName>
-                static bool unknown_attribute(BimPPContext& _context,
+                static bool unknown_attribute(TContext& _context,
                     XMLAttribute const& _attribute,
                     AttributeName const&,
                     BOOST_SCOPED_ENUM(svgpp::detail::namespace_id) namespace_id,
                     svgpp::tag::source::attribute,
                     typename boost::disable_if<typename svgpp::detail::is_char_range<AttributeName>::type>::type* = NULL)
                 {
-                    const std::string attribute_name = _attribute->name();
-                    if (attribute_name == "bimpp")
+                    if (isBimPPAttribute(_attribute))
                     {
-                        const std::string attribute_value = _attribute->value();
-                        _context.on_bimpp(attribute_value);
+                        _context.on_bimpp(_attribute->value(), _attribute->value_size());
                         return true;
                     }
-                    const std::string attribute_value = _attribute->value();
-                    if (namespace_id == svgpp::detail::namespace_id::svg)
-                        throw svgpp::unknown_attribute_error() << boost::error_info<svgpp::tag::error_info::xml_attribute, XMLAttribute>(_attribute);
-                    else
+                    if (namespace_id != svgpp::detail::namespace_id::svg)
+                    {
                         return true;
+                    }
+                    if (TContext::stats_type::lenient)
+                    {
+                        _context.on_unknown_attribute(_attribute->name(), _attribute->name_size());
+                        return true;
+                    }
+                    throw svgpp::unknown_attribute_error() << boost::error_info<svgpp::tag::error_info::xml_attribute, XMLAttribute>(_attribute);
                 }
 
                 template<class XMLAttribute, class AttributeName>
-                SVGPP_NORETURN static bool unknown_attribute(BimPPContext const&,
+                static bool unknown_attribute(TContext& _context,
                     XMLAttribute const& attribute,
                     AttributeName const& name,
                     svgpp::tag::source::css,
                     typename boost::enable_if<typename svgpp::detail::is_char_range<AttributeName>::type>::type* = NULL)
                 {
+                    if (TContext::stats_type::lenient)
+                    {
+                        _context.on_unknown_css_property(attribute->value());
+                        return true;
+                    }
                     throw svgpp::unknown_css_property_error(name) << boost::error_info<svgpp::tag::error_info::xml_attribute, XMLAttribute>(attribute);
                 }
 
                 template<class XMLAttribute, class AttributeName>
-                SVGPP_NORETURN static bool unknown_attribute(BimPPContext const&,
+                static bool unknown_attribute(TContext& _context,
                     XMLAttribute const& attribute,
                     AttributeName const&,
                     svgpp::tag::source::css,
                     typename boost::disable_if<typename svgpp::detail::is_char_range<AttributeName>::type>::type* = NULL)
                 {
+                    if (TContext::stats_type::lenient)
+                    {
+                        _context.on_unknown_css_property(attribute->value());
+                        return true;
+                    }
                     throw svgpp::unknown_css_property_error() << boost::error_info<svgpp::tag::error_info::xml_attribute, XMLAttribute>(attribute);
                 }
+
+                template<class XMLElement, class ElementName>
+                static bool unknown_element(TContext& _context, XMLElement const& _element, ElementName const& _name)
+                {
+                    if (TContext::stats_type::lenient)
+                    {
+                        _context.on_unknown_element(_element->name(), _element->name_size());
+                        return true;
+                    }
+                    return base_type::unknown_element(_context, _element, _name);
+                }
+
+                template<class XMLAttribute, class AttributeId>
+                static bool unexpected_attribute(TContext& _context, XMLAttribute const& _attribute, AttributeId _id, svgpp::tag::source::attribute _source)
+                {
+                    if (TContext::stats_type::lenient)
+                    {
+                        _context.on_invalid_value(_attribute->name(), _attribute->name_size(), _attribute->name());
+                        return true;
+                    }
+                    return base_type::unexpected_attribute(_context, _attribute, _id, _source);
+                }
+
+                template<class AttributeTag>
+                static bool required_attribute_not_found(TContext& _context, AttributeTag _tag)
+                {
+                    if (TContext::stats_type::lenient)
+                    {
+                        static const char detail[] = "missing";
+                        _context.on_invalid_value(detail, sizeof(detail) - 1, nullptr);
+                        return true;
+                    }
+                    return base_type::required_attribute_not_found(_context, _tag);
+                }
+
+                template<class AttributeTag, class AttributeValue>
+                static bool parse_failed(TContext& _context, AttributeTag _tag, AttributeValue const& _value)
+                {
+                    if (TContext::stats_type::lenient)
+                    {
+                        onInvalidValue(_context, _value);
+                        return true;
+                    }
+                    return base_type::parse_failed(_context, _tag, _value);
+                }
+
+                template<class AttributeTag, class AttributeValue>
+                static bool invalid_value(TContext& _context, AttributeTag _tag, AttributeValue const& _value)
+                {
+                    if (TContext::stats_type::lenient)
+                    {
+                        onInvalidValue(_context, _value);
+                        return true;
+                    }
+                    return base_type::invalid_value(_context, _tag, _value);
+                }
+
+                template<class AttributeTag>
+                static bool negative_value(TContext& _context, AttributeTag _tag)
+                {
+                    if (TContext::stats_type::lenient)
+                    {
+                        static const char detail[] = "negative";
+                        _context.on_invalid_value(detail, sizeof(detail) - 1, nullptr);
+                        return true;
+                    }
+                    return base_type::negative_value(_context, _tag);
+                }
             };
 
             typedef boost::mpl::set<
@@ -356,36 +844,210 @@ namespace bimpp
                 svgpp::tag::element::path
             >::type TBimPPProcessedElements;
 
-            typedef boost::mpl::set<
-                boost::mpl::pair<svgpp::tag::element::circle, svgpp::tag::attribute::cx>,
-                boost::mpl::pair<svgpp::tag::element::circle, svgpp::tag::attribute::cy>,
-                boost::mpl::pair<svgpp::tag::element::circle, svgpp::tag::attribute::r>,
-                boost::mpl::pair<svgpp::tag::element::line, svgpp::tag::attribute::x1>,
-                boost::mpl::pair<svgpp::tag::element::line, svgpp::tag::attribute::y1>,
-                boost::mpl::pair<svgpp::tag::element::line, svgpp::tag::attribute::x2>,
-                boost::mpl::pair<svgpp::tag::element::line, svgpp::tag::attribute::y2>,
-                boost::mpl::pair<svgpp::tag::element::path, svgpp::tag::attribute::d>
-            >::type TBimPPProcessedAttributesByElement;
+            typedef typename TProfile::processed_attributes TBimPPProcessedAttributesByElement;
 
-        public:
-            static bool load(std::string& _svg, house_type& _house, std::string& _error, bool _check = false)
+            // the local names of `TBimPPProcessedElements`, which are walked without svgpp.
+            static bool isProcessedElement(const rapidxml_ns::xml_node<>* _element)
+            {
+                const char* name = _element->name();
+                size_t name_size = _element->name_size();
+                const char* colon = static_cast<const char*>(std::memchr(name, ':', name_size));
+                if (colon != nullptr)
+                {
+                    name_size -= colon + 1 - name;
+                    name = colon + 1;
+                }
+                static const char* const processed_names[] = { "circle", "line", "path" };
+                for (const char* processed_name : processed_names)
+                {
+                    if (name_size == std::strlen(processed_name)
+                        && std::memcmp(name, processed_name, name_size) == 0)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            template<typename TContext>
+            static void visitElement(rapidxml_ns::xml_node<>* _element, TContext& _context)
+            {
+                _context.on_enter_element(svgpp::tag::element::any());
+                for (rapidxml_ns::xml_attribute<>* xml_attribute = _element->first_attribute(); xml_attribute != nullptr; xml_attribute = xml_attribute->next_attribute())
+                {
+                    if (BimPPErrorPolicy<TContext>::isBimPPAttribute(xml_attribute))
+                    {
+                        _context.on_bimpp(xml_attribute->value(), xml_attribute->value_size());
+                        break;
+                    }
+                }
+            }
+
+            // `profile::metadata`: the same elements as svgpp would traverse, the svg and its shapes.
+            template<typename TContext>
+            static void traverse(rapidxml_ns::xml_node<>* _svg_element, TContext& _context, std::false_type)
             {
+                visitElement(_svg_element, _context);
+                for (rapidxml_ns::xml_node<>* xml_element = _svg_element->first_node(); xml_element != nullptr; xml_element = xml_element->next_sibling())
+                {
+                    if (xml_element->type() != rapidxml_ns::node_element
+                        || !isProcessedElement(xml_element))
+                    {
+                        continue;
+                    }
+                    visitElement(xml_element, _context);
+                    _context.on_exit_element();
+                }
+                _context.on_exit_element();
+            }
+
+            template<typename TContext>
+            static void traverse(rapidxml_ns::xml_node<>* _svg_element, TContext& _context, std::true_type)
+            {
+                svgpp::document_traversal<
+                    svgpp::error_policy<BimPPErrorPolicy<TContext>>,
+                    svgpp::processed_elements<TBimPPProcessedElements>,
+                    svgpp::processed_attributes<TBimPPProcessedAttributesByElement>
+                >::load_document(_svg_element, _context);
+            }
+
+            // the previous wall of a changed or removed hole, the other entities keep nothing.
+            static void keepPrevious(const hole_type& _hole, house_delta& _delta)
+            {
+                _delta.previous_hole_wall_ids.push_back(_hole.wall_id);
+            }
+
+            template<typename TEntity>
+            static void keepPrevious(const TEntity&, house_delta&)
+            {}
+
+            // a new entity is repeated if another new entity has its id, or an entity which is not removed.
+            template<typename TPending, typename TMap>
+            static bool findRepeated(const std::vector<TPending>& _pendings, const TMap& _map, const std::unordered_set<size_t>& _removed_ids,
+                entity_type _type, std::string& _error)
+            {
+                std::unordered_set<size_t> ids;
+                for (const TPending& pending : _pendings)
+                {
+                    if (!ids.insert(pending.id).second
+                        || (_map.count(pending.id) > 0 && _removed_ids.count(pending.id) == 0))
+                    {
+                        _error = std::string(to_string(_type)) + " " + std::to_string(pending.id) + ": the id is repeated";
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // the ids of `_pendings` are not repeated, see `findRepeated`.
+            template<typename TPending, typename TMap>
+            static void applyPending(std::vector<TPending>& _pendings, TMap& _map, std::unordered_set<size_t>& _removed_ids,
+                house_index& _index, house_delta& _house_delta, entity_delta& _delta)
+            {
+                for (TPending& pending : _pendings)
+                {
+                    typename TMap::iterator itr = _map.find(pending.id);
+                    if (_removed_ids.erase(pending.id) > 0
+                        && itr != _map.end())
+                    {
+                        keepPrevious(itr->second, _house_delta);
+                        _index.remove(pending.id, itr->second);
+                        itr->second = std::move(pending.entity);
+                        _index.add(pending.id, itr->second);
+                        _delta.changed.push_back(pending.id);
+                    }
+                    else
+                    {
+                        _index.add(pending.id, pending.entity);
+                        _map.insert(std::make_pair(pending.id, std::move(pending.entity)));
+                        _delta.added.push_back(pending.id);
+                    }
+                }
+                for (size_t id : _removed_ids)
+                {
+                    typename TMap::iterator itr = _map.find(id);
+                    if (itr != _map.end())
+                    {
+                        keepPrevious(itr->second, _house_delta);
+                        _index.remove(id, itr->second);
+                        _map.erase(itr);
+                    }
+                    _delta.removed.push_back(id);
+                }
+                std::sort(_delta.removed.begin(), _delta.removed.end());
+            }
+
+            static bool validateStorage(const BimPPMapStorage& _storage, validation_report& _report, size_t _thread_count)
+            {
+                return _storage.validate(_report, _thread_count);
+            }
+
+            static bool validateStorage(const flat_house_type& _storage, validation_report& _report, size_t _thread_count)
+            {
+                return validator_type::validate(_storage, _report, _thread_count);
+            }
+
+            template<typename TStorage, typename TStats = null_stats>
+            static bool loadStorage(char* _svg, size_t _svg_size, TStorage& _storage, std::string& _error, bool _check, workspace& _workspace,
+                room_outlines_type* _outlines = nullptr, TStats* _stats = nullptr)
+            {
+                typedef BimPPContext<TStorage, TStats> context_type;
+                TStats no_stats;
+                TStats& stats = _stats != nullptr ? *_stats : no_stats;
+                if (_svg == nullptr
+                    || _svg[_svg_size] != '\0')
+                {
+                    _error = "the svg buffer is not terminated by '\\0'";
+                    return false;
+                }
                 try
                 {
-                    BimPPContext context;
-                    rapidxml_ns::xml_document<> xml_doc;
-                    xml_doc.parse<0>(&_svg[0]);
+                    if (_outlines != nullptr)
+                    {
+                        _outlines->reset();
+                    }
+                    context_type context(_storage, _workspace.json_doc, _workspace.json_allocator, stats, _outlines);
+                    rapidxml_ns::xml_document<>& xml_doc = _workspace.xml_doc;
+                    stats.setSource(_svg, _svg_size);
+                    {
+                        typename TStats::phase_scope scope(stats, load_phase::xml_parse);
+                        // the nodes of the previous loading are released here.
+                        xml_doc.clear();
+                        xml_doc.parse<0>(_svg);
+                    }
                     rapidxml_ns::xml_node<>* xml_svg_element = xml_doc.first_node("svg");
                     if (!xml_svg_element)
                     {
                         return false;
                     }
-                    svgpp::document_traversal<
-                        svgpp::error_policy<BimPPErrorPolicy>,
-                        svgpp::processed_elements<TBimPPProcessedElements>,
-                        svgpp::processed_attributes<TBimPPProcessedAttributesByElement>
-                    >::load_document(xml_svg_element, context);
-                    return context.getHouse(_house, _check);
+                    {
+                        typename TStats::phase_scope scope(stats, load_phase::traversal);
+                        traverse(xml_svg_element, context, std::integral_constant<bool, TProfile::use_svgpp>());
+                    }
+                    if (!_check)
+                    {
+                        return true;
+                    }
+                    typename TStats::phase_scope scope(stats, load_phase::validation);
+                    validation_report report;
+                    if (!validateStorage(_storage, report, _workspace.validation_thread_count))
+                    {
+                        if (TStats::lenient)
+                        {
+                            for (const validation_issue& issue : report.issues)
+                            {
+                                stats.onIssue(issue);
+                            }
+                            return true;
+                        }
+                        _error = to_string(report.issues.front());
+                        if (report.issues.size() > 1)
+                        {
+                            _error += " (and " + std::to_string(report.issues.size() - 1) + " more issues)";
+                        }
+                        return false;
+                    }
+                    return true;
                 }
                 catch (std::exception const& e)
                 {
@@ -395,6 +1057,464 @@ namespace bimpp
                 _error = "unknown reason";
                 return false;
             }
+
+        public:
+            static bool load(std::string& _svg, house_type& _house, std::string& _error, bool _check = false)
+            {
+                workspace bim_workspace;
+                return load(&_svg[0], _svg.size(), _house, _error, _check, bim_workspace);
+            }
+
+            static bool load(std::string& _svg, house_type& _house, std::string& _error, bool _check, workspace& _workspace)
+            {
+                return load(&_svg[0], _svg.size(), _house, _error, _check, _workspace);
+            }
+
+            // `_svg` is parsed in place, so it must be writable and `_svg[_svg_size]` must be '\0',
+            // e.g. the data of a `mapped_file`.
+            static bool load(char* _svg, size_t _svg_size, house_type& _house, std::string& _error, bool _check = false)
+            {
+                workspace bim_workspace;
+                return load(_svg, _svg_size, _house, _error, _check, bim_workspace);
+            }
+
+            static bool load(char* _svg, size_t _svg_size, house_type& _house, std::string& _error, bool _check, workspace& _workspace)
+            {
+                BimPPMapStorage storage;
+                if (!loadStorage(_svg, _svg_size, storage, _error, _check, _workspace))
+                {
+                    return false;
+                }
+                storage.moveTo(_house);
+                return true;
+            }
+
+            // collect the time of the phases, the counts of the elements and the rejected `bimpp` attributes in `_stats`.
+            static bool load(char* _svg, size_t _svg_size, house_type& _house, std::string& _error, bool _check, workspace& _workspace, load_stats& _stats)
+            {
+                BimPPMapStorage storage;
+                if (!loadStorage(_svg, _svg_size, storage, _error, _check, _workspace, nullptr, &_stats))
+                {
+                    return false;
+                }
+                load_stats::phase_scope scope(_stats, load_phase::house_copy);
+                storage.moveTo(_house);
+                return true;
+            }
+
+            static bool load(char* _svg, size_t _svg_size, flat_house_type& _house, std::string& _error, bool _check, workspace& _workspace, load_stats& _stats)
+            {
+                _house.reset();
+                return loadStorage(_svg, _svg_size, _house, _error, _check, _workspace, nullptr, &_stats);
+            }
+
+            // bulk load `_index` over the nodes and the walls of the house, while its storage is still hot in the cache.
+            static bool load(char* _svg, size_t _svg_size, house_type& _house, std::string& _error, bool _check, workspace& _workspace, spatial_index_type& _index)
+            {
+                if (!load(_svg, _svg_size, _house, _error, _check, _workspace))
+                {
+                    _index.clear();
+                    return false;
+                }
+                _index.build(_house);
+                return true;
+            }
+
+            static bool load(char* _svg, size_t _svg_size, flat_house_type& _house, std::string& _error, bool _check, workspace& _workspace, spatial_index_type& _index)
+            {
+                if (!load(_svg, _svg_size, _house, _error, _check, _workspace))
+                {
+                    _index.clear();
+                    return false;
+                }
+                _index.build(_house);
+                return true;
+            }
+
+            // the lenient loading skips the unknown attributes and css properties instead of throwing,
+            // and records them in `_diagnostics` with the rejected `bimpp` attributes and the issues of `_check`.
+            // it only fails if the xml cannot be parsed, otherwise the house holds everything which could be loaded.
+            static bool load(char* _svg, size_t _svg_size, house_type& _house, std::string& _error, bool _check, workspace& _workspace, diagnostics& _diagnostics)
+            {
+                BimPPMapStorage storage;
+                _diagnostics.clear();
+                const bool loaded = loadStorage(_svg, _svg_size, storage, _error, _check, _workspace, nullptr, &_diagnostics);
+                _diagnostics.resolve(_workspace.xml_doc);
+                if (!loaded)
+                {
+                    return false;
+                }
+                storage.moveTo(_house);
+                return true;
+            }
+
+            static bool load(std::string& _svg, house_type& _house, std::string& _error, diagnostics& _diagnostics, bool _check = false)
+            {
+                workspace bim_workspace;
+                return load(&_svg[0], _svg.size(), _house, _error, _check, bim_workspace, _diagnostics);
+            }
+
+            static bool load(char* _svg, size_t _svg_size, flat_house_type& _house, std::string& _error, bool _check, workspace& _workspace, diagnostics& _diagnostics)
+            {
+                _house.reset();
+                _diagnostics.clear();
+                const bool loaded = loadStorage(_svg, _svg_size, _house, _error, _check, _workspace, nullptr, &_diagnostics);
+                _diagnostics.resolve(_workspace.xml_doc);
+                return loaded;
+            }
+
+            // load the outlines of the rooms too, the curves are flattened with `room_outlines::tolerance`.
+            static bool load(std::string& _svg, house_type& _house, room_outlines_type& _outlines, std::string& _error, bool _check = false)
+            {
+                return load(&_svg[0], _svg.size(), _house, _outlines, _error, _check);
+            }
+
+            static bool load(char* _svg, size_t _svg_size, house_type& _house, room_outlines_type& _outlines, std::string& _error, bool _check = false)
+            {
+                static_assert(TProfile::geometry, "the geometry is not decoded by the profile of this loader");
+                workspace bim_workspace;
+                BimPPMapStorage storage;
+                if (!loadStorage(_svg, _svg_size, storage, _error, _check, bim_workspace, &_outlines))
+                {
+                    return false;
+                }
+                storage.moveTo(_house);
+                return true;
+            }
+
+            // return the house by value, it is `boost::none` if the loading fails.
+            static boost::optional<house_type> load(std::string& _svg, std::string& _error, bool _check = false)
+            {
+                house_type bim_house;
+                if (!load(_svg, bim_house, _error, _check))
+                {
+                    return boost::none;
+                }
+                return boost::optional<house_type>(std::move(bim_house));
+            }
+
+            // load to the structure-of-arrays storage, `flat_house::toHouse` converts it to the maps on demand.
+            static bool load(std::string& _svg, flat_house_type& _house, std::string& _error, bool _check = false)
+            {
+                workspace bim_workspace;
+                return load(_svg, _house, _error, _check, bim_workspace);
+            }
+
+            static bool load(std::string& _svg, flat_house_type& _house, std::string& _error, bool _check, workspace& _workspace)
+            {
+                return load(&_svg[0], _svg.size(), _house, _error, _check, _workspace);
+            }
+
+            static bool load(char* _svg, size_t _svg_size, flat_house_type& _house, std::string& _error, bool _check = false)
+            {
+                workspace bim_workspace;
+                return load(_svg, _svg_size, _house, _error, _check, bim_workspace);
+            }
+
+            static bool load(char* _svg, size_t _svg_size, flat_house_type& _house, std::string& _error, bool _check, workspace& _workspace)
+            {
+                _house.reset();
+                return loadStorage(_svg, _svg_size, _house, _error, _check, _workspace);
+            }
+
+            static bool load(std::string& _svg, flat_house_type& _house, room_outlines_type& _outlines, std::string& _error, bool _check = false)
+            {
+                return load(&_svg[0], _svg.size(), _house, _outlines, _error, _check);
+            }
+
+            static bool load(char* _svg, size_t _svg_size, flat_house_type& _house, room_outlines_type& _outlines, std::string& _error, bool _check = false)
+            {
+                static_assert(TProfile::geometry, "the geometry is not decoded by the profile of this loader");
+                workspace bim_workspace;
+                _house.reset();
+                return loadStorage(_svg, _svg_size, _house, _error, _check, bim_workspace, &_outlines);
+            }
+
+            // scan the svg without building the DOM and pass every entity to `_sink` as soon as its `bimpp` attribute is found.
+            // `TSink` has the members `addNode(size_t, precision_type, precision_type)`, `addWall(size_t, wall_type&&)`,
+            // `addHole(size_t, hole_type&&)` and `addRoom(size_t, room_type&&)`, e.g. `flat_house`.
+            // `_svg` is scanned in place, so it must be writable and `_svg[_svg_size]` must be '\0'.
+            template<typename TSink>
+            static bool stream(char* _svg, size_t _svg_size, TSink& _sink, std::string& _error)
+            {
+                workspace bim_workspace;
+                null_stats no_stats;
+                BimPPContext<TSink> context(_sink, bim_workspace.json_doc, bim_workspace.json_allocator, no_stats);
+                auto on_bimpp = [&context](char* _bimpp, size_t _bimpp_size, uint64_t)
+                {
+                    context.on_bimpp(_bimpp, _bimpp_size);
+                    context.on_exit_element();
+                };
+                try
+                {
+                    bimpp_scanner scanner;
+                    if (scanner.scan(_svg, _svg + _svg_size, true, on_bimpp) == nullptr)
+                    {
+                        _error = scanner.getError();
+                        return false;
+                    }
+                    return scanner.hasRoot();
+                }
+                catch (std::exception const& e)
+                {
+                    _error = e.what();
+                    return false;
+                }
+            }
+
+            // read `_input` in chunks of `_chunk_size` bytes, the memory is bounded by the largest single tag.
+            template<typename TSink>
+            static bool stream(std::istream& _input, TSink& _sink, std::string& _error, size_t _chunk_size = 64 * 1024)
+            {
+                workspace bim_workspace;
+                null_stats no_stats;
+                BimPPContext<TSink> context(_sink, bim_workspace.json_doc, bim_workspace.json_allocator, no_stats);
+                auto on_bimpp = [&context](char* _bimpp, size_t _bimpp_size, uint64_t)
+                {
+                    context.on_bimpp(_bimpp, _bimpp_size);
+                    context.on_exit_element();
+                };
+                try
+                {
+                    bimpp_scanner scanner;
+                    // one more byte for the '\0' after the data.
+                    std::vector<char> buffer(std::max<size_t>(_chunk_size, 1) + 1);
+                    size_t buffer_size = 0;
+                    for (;;)
+                    {
+                        if (buffer_size + 1 == buffer.size())
+                        {
+                            // a single construct is larger than the buffer.
+                            buffer.resize(2 * buffer.size() - 1);
+                        }
+                        _input.read(buffer.data() + buffer_size, buffer.size() - 1 - buffer_size);
+                        if (_input.bad())
+                        {
+                            _error = "can not read the svg";
+                            return false;
+                        }
+                        buffer_size += static_cast<size_t>(_input.gcount());
+                        buffer[buffer_size] = '\0';
+                        const bool is_final = !_input.good();
+                        char* buffer_end = buffer.data() + buffer_size;
+                        char* rest = scanner.scan(buffer.data(), buffer_end, is_final, on_bimpp);
+                        if (rest == nullptr)
+                        {
+                            _error = scanner.getError();
+                            return false;
+                        }
+                        if (is_final)
+                        {
+                            break;
+                        }
+                        buffer_size = static_cast<size_t>(buffer_end - rest);
+                        std::memmove(buffer.data(), rest, buffer_size);
+                    }
+                    return scanner.hasRoot();
+                }
+                catch (std::exception const& e)
+                {
+                    _error = e.what();
+                    return false;
+                }
+            }
+
+            // update `_house` to the svg and fill `_delta` with the entities which differ from the previous `reload` of `_state`.
+            // an element is known by the hash of its `bimpp` attribute and of its geometry attributes, so a moved path is changed too.
+            // every reload scans and hashes the whole svg without a DOM, that linear pass is the floor of its cost.
+            // only the new elements are decoded, and `_house`, the index of `_state` and `_delta` are updated
+            // in proportion to the edit, as `collectAffectedRooms` is with the index. `_check` validates the whole house.
+            // `_house` must be the house of the previous `reload` of `_state`, it is reset if `_state` is empty,
+            // and `_state` is reset if the svg is malformed.
+            // a repeated id fails the reload and resets `_state` too, `load` would keep the first element of the id
+            // and the house could not follow the removal of that element.
+            static bool reload(char* _svg, size_t _svg_size, house_type& _house, incremental_state& _state, house_delta& _delta, std::string& _error, bool _check = false)
+            {
+                _delta.clear();
+                if (_svg == nullptr
+                    || _svg[_svg_size] != '\0')
+                {
+                    _error = "the svg buffer is not terminated by '\\0'";
+                    return false;
+                }
+                if (_state.elements.empty())
+                {
+                    _house.reset();
+                }
+                const size_t generation = ++_state.generation;
+                std::string repeated_error;
+
+                BimPPDeltaStorage storage;
+                null_stats no_stats;
+                BimPPContext<BimPPDeltaStorage> context(storage, _state.bim_workspace.json_doc, _state.bim_workspace.json_allocator, no_stats);
+                // the elements of the previous reload which are found again.
+                size_t found_count = 0;
+                const size_t previous_count = _state.elements.size();
+                auto on_bimpp = [&_state, &storage, &context, &repeated_error, &found_count, generation](char* _bimpp, size_t _bimpp_size, uint64_t _geometry_hash)
+                {
+                    const uint64_t hash = hashContent(_bimpp, _bimpp_size, _geometry_hash);
+                    typename std::unordered_map<uint64_t, element_record>::iterator itr = _state.elements.find(hash);
+                    if (itr != _state.elements.end())
+                    {
+                        if (itr->second.generation != generation)
+                        {
+                            itr->second.generation = generation;
+                            ++found_count;
+                        }
+                        else if (itr->second.has_entity
+                            && repeated_error.empty())
+                        {
+                            // the same element twice.
+                            repeated_error = std::string(to_string(itr->second.type)) + " " + std::to_string(itr->second.id) + ": the id is repeated";
+                        }
+                        return;
+                    }
+                    context.on_bimpp(_bimpp, _bimpp_size);
+                    context.on_exit_element();
+                    element_record record;
+                    storage.takeLast(record);
+                    record.generation = generation;
+                    _state.elements.insert(std::make_pair(hash, record));
+                };
+                try
+                {
+                    bimpp_scanner scanner(true);
+                    if (scanner.scan(_svg, _svg + _svg_size, true, on_bimpp) == nullptr
+                        || !scanner.hasRoot())
+                    {
+                        _error = scanner.hasRoot() ? scanner.getError() : "the svg element is not found";
+                        _state.reset();
+                        return false;
+                    }
+                }
+                catch (std::exception const& e)
+                {
+                    _error = e.what();
+                    _state.reset();
+                    return false;
+                }
+
+                // the elements which are not found any more are removed, unless a new element has the same id.
+                // the sweep stops after the last missing element, and is skipped if every previous element is found again.
+                std::array<std::unordered_set<size_t>, 4> removed_ids;
+                size_t missing_count = previous_count - found_count;
+                for (typename std::unordered_map<uint64_t, element_record>::iterator itr = _state.elements.begin();
+                    missing_count > 0 && itr != _state.elements.end();)
+                {
+                    if (itr->second.generation == generation)
+                    {
+                        ++itr;
+                        continue;
+                    }
+                    if (itr->second.has_entity)
+                    {
+                        removed_ids[static_cast<size_t>(itr->second.type)].insert(itr->second.id);
+                    }
+                    itr = _state.elements.erase(itr);
+                    --missing_count;
+                }
+                if (!repeated_error.empty()
+                    || findRepeated(storage.nodes, _house.nodes, removed_ids[static_cast<size_t>(entity_type::node)], entity_type::node, repeated_error)
+                    || findRepeated(storage.walls, _house.walls, removed_ids[static_cast<size_t>(entity_type::wall)], entity_type::wall, repeated_error)
+                    || findRepeated(storage.holes, _house.holes, removed_ids[static_cast<size_t>(entity_type::hole)], entity_type::hole, repeated_error)
+                    || findRepeated(storage.rooms, _house.rooms, removed_ids[static_cast<size_t>(entity_type::room)], entity_type::room, repeated_error))
+                {
+                    _error = repeated_error;
+                    _state.reset();
+                    return false;
+                }
+
+                applyPending(storage.nodes, _house.nodes, removed_ids[static_cast<size_t>(entity_type::node)], _state.index, _delta, _delta.nodes);
+                applyPending(storage.walls, _house.walls, removed_ids[static_cast<size_t>(entity_type::wall)], _state.index, _delta, _delta.walls);
+                applyPending(storage.holes, _house.holes, removed_ids[static_cast<size_t>(entity_type::hole)], _state.index, _delta, _delta.holes);
+                applyPending(storage.rooms, _house.rooms, removed_ids[static_cast<size_t>(entity_type::room)], _state.index, _delta, _delta.rooms);
+                if (!_check)
+                {
+                    return true;
+                }
+                validation_report report;
+                if (!validator_type::validate(_house, report, _state.bim_workspace.validation_thread_count))
+                {
+                    _error = to_string(report.issues.front());
+                    if (report.issues.size() > 1)
+                    {
+                        _error += " (and " + std::to_string(report.issues.size() - 1) + " more issues)";
+                    }
+                    return false;
+                }
+                return true;
+            }
+
+            static bool reload(std::string& _svg, house_type& _house, incremental_state& _state, house_delta& _delta, std::string& _error, bool _check = false)
+            {
+                return reload(&_svg[0], _svg.size(), _house, _state, _delta, _error, _check);
+            }
+
+            // load the svg files of `_paths` on `_thread_count` threads, all the cores are used if it is 0.
+            // `_results[i]` is the result of `_paths[i]`, every thread only writes the results of its own files.
+            // if a thread can not be started, the exception is thrown once the other threads have loaded all the files.
+            static batch_summary load_many(const std::vector<std::string>& _paths, std::vector<batch_result>& _results, bool _check = false, size_t _thread_count = 0)
+            {
+                if (_thread_count == 0)
+                {
+                    _thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+                }
+                _thread_count = std::max<size_t>(std::min(_thread_count, _paths.size()), 1);
+
+                _results.clear();
+                _results.resize(_paths.size());
+
+                const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+                work_stealing_scheduler scheduler(_paths.size(), _thread_count);
+                auto run_worker = [&_paths, &_results, &scheduler, _check](size_t _worker)
+                {
+                    std::unique_ptr<workspace> bim_workspace(new workspace());
+                    // the files are already loaded in parallel.
+                    bim_workspace->validation_thread_count = 1;
+                    std::string svg_context;
+                    size_t task = 0;
+                    while (scheduler.next(_worker, task))
+                    {
+                        const std::chrono::steady_clock::time_point task_start_time = std::chrono::steady_clock::now();
+                        batch_result& result = _results[task];
+                        result.path = _paths[task];
+                        try
+                        {
+                            if (!read_file(result.path, svg_context))
+                            {
+                                result.error = "can not read the file";
+                            }
+                            else
+                            {
+                                result.bytes = svg_context.size();
+                                result.success = load(svg_context, result.house, result.error, _check, *bim_workspace);
+                            }
+                        }
+                        catch (std::exception const& e)
+                        {
+                            result.success = false;
+                            result.error = e.what();
+                        }
+                        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - task_start_time).count();
+                    }
+                };
+
+                runWorkers(_thread_count, run_worker);
+
+                batch_summary summary;
+                summary.file_count = _results.size();
+                summary.thread_count = _thread_count;
+                summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+                for (const batch_result& result : _results)
+                {
+                    summary.bytes += result.bytes;
+                    if (!result.success)
+                    {
+                        ++summary.failed_count;
+                    }
+                }
+                return summary;
+            }
         };
     }
 }
\ No newline at end of file
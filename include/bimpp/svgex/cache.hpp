@@ -0,0 +1,531 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include <bimpp/plan2d.hpp>
+#include <bimpp/svgex/file.hpp>
+#include <bimpp/svgex/symbol_table.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // the 64 bits hash of a whole svg file, which keys its cache. the words are mixed 8 bytes at a time,
+        // so it is much cheaper than the parsing.
+        inline uint64_t hashSource(const char* _data, size_t _size)
+        {
+            const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+            uint64_t hash = 0x84222325CBF29CE4ull ^ (_size * multiplier);
+            size_t i = 0;
+            for (; i + 8 <= _size; i += 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, _data + i, 8);
+                hash = (hash ^ word) * multiplier;
+                hash ^= hash >> 29;
+            }
+            uint64_t tail = 0;
+            std::memcpy(&tail, _data + i, _size - i);
+            hash = (hash ^ tail) * multiplier;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+        // a house in a fixed binary layout, which is used in place from a mapped file.
+        // the file is a `header` followed by the sections of the records, every section is aligned to 8 bytes.
+        // the records of every kind are sorted by id, the `kind` and `direction` strings are symbols
+        // of a string table. the layout is native, a file is only read by a build with the same precision and byte order.
+        template<typename TConstant = plan2d::constant<>>
+        class house_cache
+        {
+        public:
+            typedef typename TConstant::precision_type      precision_type;
+            typedef typename plan2d::node<TConstant>        node_type;
+            typedef typename plan2d::wall<TConstant>        wall_type;
+            typedef typename plan2d::hole<TConstant>        hole_type;
+            typedef typename plan2d::room<TConstant>        room_type;
+            typedef typename plan2d::house<TConstant>       house_type;
+
+            static const uint32_t version = 1;
+
+            struct header
+            {
+                char        magic[8];
+                uint32_t    version;
+                uint32_t    precision_size;
+                uint64_t    source_hash;
+                uint64_t    node_count;
+                uint64_t    wall_count;
+                uint64_t    hole_count;
+                uint64_t    room_count;
+                uint64_t    room_wall_id_count;
+                uint64_t    symbol_count;
+                uint64_t    symbol_data_size;
+                uint64_t    file_size;
+            };
+
+            struct node_record
+            {
+                uint64_t        id;
+                precision_type  x;
+                precision_type  y;
+            };
+
+            struct wall_record
+            {
+                uint64_t        id;
+                uint64_t        start_node_id;
+                uint64_t        end_node_id;
+                precision_type  thickness;
+                uint32_t        kind;
+            };
+
+            struct hole_record
+            {
+                uint64_t        id;
+                uint64_t        wall_id;
+                precision_type  distance;
+                precision_type  width;
+                uint32_t        kind;
+                uint32_t        direction;
+            };
+
+            // the wall ids of a room are `getRoomWallIds()[wall_id_offset, wall_id_offset + wall_id_count)`.
+            struct room_record
+            {
+                uint64_t        id;
+                uint64_t        wall_id_offset;
+                uint32_t        wall_id_count;
+                uint32_t        kind;
+            };
+
+        public:
+            house_cache()
+                : cache_header(nullptr)
+                , nodes(nullptr)
+                , walls(nullptr)
+                , holes(nullptr)
+                , rooms(nullptr)
+                , room_wall_ids(nullptr)
+                , symbol_offsets(nullptr)
+                , symbol_data(nullptr)
+            {}
+
+            house_cache(const house_cache&) = delete;
+            house_cache& operator=(const house_cache&) = delete;
+
+            // write `_house` to `_data` in the layout of the cache.
+            static void serialize(const house_type& _house, uint64_t _source_hash, std::string& _data)
+            {
+                symbol_table symbols;
+
+                header cache_header;
+                std::memset(&cache_header, 0, sizeof(cache_header));
+                std::memcpy(cache_header.magic, "BIMPPHC", 8);
+                cache_header.version = version;
+                cache_header.precision_size = sizeof(precision_type);
+                cache_header.source_hash = _source_hash;
+                cache_header.node_count = _house.nodes.size();
+                cache_header.wall_count = _house.walls.size();
+                cache_header.hole_count = _house.holes.size();
+                cache_header.room_count = _house.rooms.size();
+
+                std::vector<node_record> nodes;
+                nodes.reserve(_house.nodes.size());
+                for (std::pair<const size_t, node_type> const& node_pair : _house.nodes)
+                {
+                    node_record record;
+                    std::memset(&record, 0, sizeof(record));
+                    record.id = node_pair.first;
+                    record.x = node_pair.second.x;
+                    record.y = node_pair.second.y;
+                    nodes.push_back(record);
+                }
+                std::vector<wall_record> walls;
+                walls.reserve(_house.walls.size());
+                for (std::pair<const size_t, wall_type> const& wall_pair : _house.walls)
+                {
+                    wall_record record;
+                    std::memset(&record, 0, sizeof(record));
+                    record.id = wall_pair.first;
+                    record.start_node_id = wall_pair.second.start_node_id;
+                    record.end_node_id = wall_pair.second.end_node_id;
+                    record.thickness = wall_pair.second.thickness;
+                    record.kind = symbols.intern(wall_pair.second.kind);
+                    walls.push_back(record);
+                }
+                std::vector<hole_record> holes;
+                holes.reserve(_house.holes.size());
+                for (std::pair<const size_t, hole_type> const& hole_pair : _house.holes)
+                {
+                    hole_record record;
+                    std::memset(&record, 0, sizeof(record));
+                    record.id = hole_pair.first;
+                    record.wall_id = hole_pair.second.wall_id;
+                    record.distance = hole_pair.second.distance;
+                    record.width = hole_pair.second.width;
+                    record.kind = symbols.intern(hole_pair.second.kind);
+                    record.direction = symbols.intern(hole_pair.second.direction);
+                    holes.push_back(record);
+                }
+                std::vector<room_record> rooms;
+                std::vector<uint64_t> room_wall_ids;
+                rooms.reserve(_house.rooms.size());
+                for (std::pair<const size_t, room_type> const& room_pair : _house.rooms)
+                {
+                    room_record record;
+                    std::memset(&record, 0, sizeof(record));
+                    record.id = room_pair.first;
+                    record.wall_id_offset = room_wall_ids.size();
+                    record.wall_id_count = static_cast<uint32_t>(room_pair.second.wall_ids.size());
+                    record.kind = symbols.intern(room_pair.second.kind);
+                    room_wall_ids.insert(room_wall_ids.end(), room_pair.second.wall_ids.cbegin(), room_pair.second.wall_ids.cend());
+                    rooms.push_back(record);
+                }
+                cache_header.room_wall_id_count = room_wall_ids.size();
+
+                // the symbol i is `symbol_data[symbol_offsets[i], symbol_offsets[i + 1])`, followed by a '\0'.
+                std::vector<uint64_t> symbol_offsets(1, 0);
+                std::string symbol_data;
+                for (uint32_t symbol = 0; symbol < symbols.size(); ++symbol)
+                {
+                    symbol_data += symbols.getString(symbol);
+                    symbol_data += '\0';
+                    symbol_offsets.push_back(symbol_data.size());
+                }
+                cache_header.symbol_count = symbols.size();
+                cache_header.symbol_data_size = symbol_data.size();
+
+                _data.clear();
+                _data.reserve(sizeof(header)
+                    + nodes.size() * sizeof(node_record) + walls.size() * sizeof(wall_record)
+                    + holes.size() * sizeof(hole_record) + rooms.size() * sizeof(room_record)
+                    + room_wall_ids.size() * sizeof(uint64_t) + symbol_offsets.size() * sizeof(uint64_t) + symbol_data.size() + 64);
+                append(_data, &cache_header, sizeof(cache_header));
+                append(_data, nodes.data(), nodes.size() * sizeof(node_record));
+                append(_data, walls.data(), walls.size() * sizeof(wall_record));
+                append(_data, holes.data(), holes.size() * sizeof(hole_record));
+                append(_data, rooms.data(), rooms.size() * sizeof(room_record));
+                append(_data, room_wall_ids.data(), room_wall_ids.size() * sizeof(uint64_t));
+                append(_data, symbol_offsets.data(), symbol_offsets.size() * sizeof(uint64_t));
+                append(_data, symbol_data.data(), symbol_data.size());
+                const uint64_t file_size = _data.size();
+                std::memcpy(&_data[offsetof(header, file_size)], &file_size, sizeof(file_size));
+            }
+
+            // write `_house` to the file at `_path`, it is written to a temporary file which replaces `_path`,
+            // so a reader never sees a partial cache.
+            static bool save(const house_type& _house, uint64_t _source_hash, const std::string& _path)
+            {
+                std::string data;
+                serialize(_house, _source_hash, data);
+                return replace_file(_path, data);
+            }
+
+            // map the cache at `_path`, it fails if the file is not a cache of the svg with `_source_hash`.
+            bool open(const std::string& _path, uint64_t _source_hash)
+            {
+                close();
+                if (!file.open(_path))
+                {
+                    return false;
+                }
+                if (!attach(file.data(), file.size(), _source_hash))
+                {
+                    close();
+                    return false;
+                }
+                return true;
+            }
+
+            // use a cache which is already in the memory, e.g. the house of a daemon response.
+            // `_data` must be aligned to 8 bytes and outlive the cache.
+            bool open(const char* _data, size_t _size, uint64_t _source_hash)
+            {
+                close();
+                if (!attach(_data, _size, _source_hash))
+                {
+                    close();
+                    return false;
+                }
+                return true;
+            }
+
+            void close()
+            {
+                file.close();
+                cache_header = nullptr;
+            }
+
+            bool isOpen() const
+            {
+                return cache_header != nullptr;
+            }
+
+            size_t getNodeCount() const { return static_cast<size_t>(cache_header->node_count); }
+            size_t getWallCount() const { return static_cast<size_t>(cache_header->wall_count); }
+            size_t getHoleCount() const { return static_cast<size_t>(cache_header->hole_count); }
+            size_t getRoomCount() const { return static_cast<size_t>(cache_header->room_count); }
+            size_t getSymbolCount() const { return static_cast<size_t>(cache_header->symbol_count); }
+
+            const node_record* getNodes() const { return nodes; }
+            const wall_record* getWalls() const { return walls; }
+            const hole_record* getHoles() const { return holes; }
+            const room_record* getRooms() const { return rooms; }
+            const uint64_t* getRoomWallIds() const { return room_wall_ids; }
+
+            // the records are found by a binary search, it is nullptr if the id is not found.
+            const node_record* findNode(size_t _id) const { return findRecord(nodes, getNodeCount(), _id); }
+            const wall_record* findWall(size_t _id) const { return findRecord(walls, getWallCount(), _id); }
+            const hole_record* findHole(size_t _id) const { return findRecord(holes, getHoleCount(), _id); }
+            const room_record* findRoom(size_t _id) const { return findRecord(rooms, getRoomCount(), _id); }
+
+            // the symbol is terminated by '\0'.
+            const char* getSymbol(uint32_t _symbol) const
+            {
+                return symbol_data + symbol_offsets[_symbol];
+            }
+
+            size_t getSymbolSize(uint32_t _symbol) const
+            {
+                return static_cast<size_t>(symbol_offsets[_symbol + 1] - symbol_offsets[_symbol]) - 1;
+            }
+
+            // build the std::map based house, the records are sorted so every insertion is at the end.
+            void toHouse(house_type& _house) const
+            {
+                _house.reset();
+                for (size_t i = 0; i < getNodeCount(); ++i)
+                {
+                    _house.nodes.insert(_house.nodes.end(), std::make_pair(static_cast<size_t>(nodes[i].id), node_type(nodes[i].x, nodes[i].y)));
+                }
+                for (size_t i = 0; i < getWallCount(); ++i)
+                {
+                    wall_type bim_wall;
+                    bim_wall.kind.assign(getSymbol(walls[i].kind), getSymbolSize(walls[i].kind));
+                    bim_wall.start_node_id = static_cast<size_t>(walls[i].start_node_id);
+                    bim_wall.end_node_id = static_cast<size_t>(walls[i].end_node_id);
+                    bim_wall.thickness = walls[i].thickness;
+                    _house.walls.insert(_house.walls.end(), std::make_pair(static_cast<size_t>(walls[i].id), std::move(bim_wall)));
+                }
+                for (size_t i = 0; i < getHoleCount(); ++i)
+                {
+                    hole_type bim_hole;
+                    bim_hole.kind.assign(getSymbol(holes[i].kind), getSymbolSize(holes[i].kind));
+                    bim_hole.direction.assign(getSymbol(holes[i].direction), getSymbolSize(holes[i].direction));
+                    bim_hole.wall_id = static_cast<size_t>(holes[i].wall_id);
+                    bim_hole.distance = holes[i].distance;
+                    bim_hole.width = holes[i].width;
+                    _house.holes.insert(_house.holes.end(), std::make_pair(static_cast<size_t>(holes[i].id), std::move(bim_hole)));
+                }
+                for (size_t i = 0; i < getRoomCount(); ++i)
+                {
+                    room_type bim_room;
+                    bim_room.kind.assign(getSymbol(rooms[i].kind), getSymbolSize(rooms[i].kind));
+                    const uint64_t* wall_ids = room_wall_ids + rooms[i].wall_id_offset;
+                    bim_room.wall_ids.assign(wall_ids, wall_ids + rooms[i].wall_id_count);
+                    _house.rooms.insert(_house.rooms.end(), std::make_pair(static_cast<size_t>(rooms[i].id), std::move(bim_room)));
+                }
+            }
+
+        private:
+            static void append(std::string& _data, const void* _bytes, size_t _size)
+            {
+                _data.append(static_cast<const char*>(_bytes), _size);
+                // the next section starts at a multiple of 8 bytes.
+                _data.append((8 - _data.size() % 8) % 8, '\0');
+            }
+
+            static size_t alignedSize(uint64_t _size)
+            {
+                return static_cast<size_t>((_size + 7) / 8 * 8);
+            }
+
+            template<typename TRecord>
+            static const TRecord* findRecord(const TRecord* _records, size_t _count, size_t _id)
+            {
+                const TRecord* itr = std::lower_bound(_records, _records + _count, _id,
+                    [](const TRecord& _record, size_t _target_id) { return _record.id < _target_id; });
+                if (itr == _records + _count
+                    || itr->id != _id)
+                {
+                    return nullptr;
+                }
+                return itr;
+            }
+
+            // the binary search of `findRecord` and the insertions at the end of `toHouse` need strictly increasing ids.
+            template<typename TRecord>
+            static bool areIdsIncreasing(const TRecord* _records, uint64_t _count)
+            {
+                for (uint64_t i = 1; i < _count; ++i)
+                {
+                    if (_records[i].id <= _records[i - 1].id)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // a record count which can not fit in `_size` bytes, its section size would overflow.
+            static bool isCountTooLarge(uint64_t _count, size_t _record_size, size_t _size)
+            {
+                return _count > _size / _record_size;
+            }
+
+            // check the header, that every section is inside the file, that the ids of every section strictly increase
+            // and that every index of a record is inside its section, then point at the sections. a cache which passes is used without any other check.
+            bool attach(const char* _data, size_t _size, uint64_t _source_hash)
+            {
+                if (_size < sizeof(header))
+                {
+                    return false;
+                }
+                const header* file_header = reinterpret_cast<const header*>(_data);
+                if (std::memcmp(file_header->magic, "BIMPPHC", 8) != 0
+                    || file_header->version != version
+                    || file_header->precision_size != sizeof(precision_type)
+                    || file_header->source_hash != _source_hash
+                    || file_header->file_size != _size)
+                {
+                    return false;
+                }
+                if (file_header->symbol_count >= UINT32_MAX
+                    || isCountTooLarge(file_header->node_count, sizeof(node_record), _size)
+                    || isCountTooLarge(file_header->wall_count, sizeof(wall_record), _size)
+                    || isCountTooLarge(file_header->hole_count, sizeof(hole_record), _size)
+                    || isCountTooLarge(file_header->room_count, sizeof(room_record), _size)
+                    || isCountTooLarge(file_header->room_wall_id_count, sizeof(uint64_t), _size)
+                    || isCountTooLarge(file_header->symbol_count + 1, sizeof(uint64_t), _size)
+                    || file_header->symbol_data_size > _size)
+                {
+                    return false;
+                }
+                const uint64_t section_sizes[] =
+                {
+                    file_header->node_count * sizeof(node_record),
+                    file_header->wall_count * sizeof(wall_record),
+                    file_header->hole_count * sizeof(hole_record),
+                    file_header->room_count * sizeof(room_record),
+                    file_header->room_wall_id_count * sizeof(uint64_t),
+                    (file_header->symbol_count + 1) * sizeof(uint64_t),
+                    file_header->symbol_data_size
+                };
+                const char* section_begins[7];
+                uint64_t offset = alignedSize(sizeof(header));
+                for (size_t i = 0; i < 7; ++i)
+                {
+                    section_begins[i] = _data + offset;
+                    offset += alignedSize(section_sizes[i]);
+                    if (offset > _size)
+                    {
+                        return false;
+                    }
+                }
+                const node_record* file_nodes = reinterpret_cast<const node_record*>(section_begins[0]);
+                const wall_record* file_walls = reinterpret_cast<const wall_record*>(section_begins[1]);
+                const hole_record* file_holes = reinterpret_cast<const hole_record*>(section_begins[2]);
+                const room_record* file_rooms = reinterpret_cast<const room_record*>(section_begins[3]);
+                const uint64_t* file_symbol_offsets = reinterpret_cast<const uint64_t*>(section_begins[5]);
+                const char* file_symbol_data = section_begins[6];
+
+                if (!areIdsIncreasing(file_nodes, file_header->node_count)
+                    || !areIdsIncreasing(file_walls, file_header->wall_count)
+                    || !areIdsIncreasing(file_holes, file_header->hole_count)
+                    || !areIdsIncreasing(file_rooms, file_header->room_count))
+                {
+                    return false;
+                }
+
+                // every symbol is at least its '\0', so the offsets increase up to the end of the data.
+                const uint64_t symbol_count = file_header->symbol_count;
+                if (file_symbol_offsets[0] != 0
+                    || file_symbol_offsets[symbol_count] != file_header->symbol_data_size)
+                {
+                    return false;
+                }
+                for (uint64_t i = 0; i < symbol_count; ++i)
+                {
+                    if (file_symbol_offsets[i + 1] <= file_symbol_offsets[i]
+                        || file_symbol_offsets[i + 1] > file_header->symbol_data_size
+                        || file_symbol_data[file_symbol_offsets[i + 1] - 1] != '\0')
+                    {
+                        return false;
+                    }
+                }
+                for (uint64_t i = 0; i < file_header->wall_count; ++i)
+                {
+                    if (file_walls[i].kind >= symbol_count)
+                    {
+                        return false;
+                    }
+                }
+                for (uint64_t i = 0; i < file_header->hole_count; ++i)
+                {
+                    if (file_holes[i].kind >= symbol_count
+                        || file_holes[i].direction >= symbol_count)
+                    {
+                        return false;
+                    }
+                }
+                for (uint64_t i = 0; i < file_header->room_count; ++i)
+                {
+                    if (file_rooms[i].kind >= symbol_count
+                        || file_rooms[i].wall_id_offset > file_header->room_wall_id_count
+                        || file_rooms[i].wall_id_count > file_header->room_wall_id_count - file_rooms[i].wall_id_offset)
+                    {
+                        return false;
+                    }
+                }
+                nodes = file_nodes;
+                walls = file_walls;
+                holes = file_holes;
+                rooms = file_rooms;
+                room_wall_ids = reinterpret_cast<const uint64_t*>(section_begins[4]);
+                symbol_offsets = file_symbol_offsets;
+                symbol_data = file_symbol_data;
+                cache_header = file_header;
+                return true;
+            }
+
+        private:
+            mapped_file         file;
+            const header*       cache_header;
+            const node_record*  nodes;
+            const wall_record*  walls;
+            const hole_record*  holes;
+            const room_record*  rooms;
+            const uint64_t*     room_wall_ids;
+            const uint64_t*     symbol_offsets;
+            const char*         symbol_data;
+        };
+    }
+}
@@ -0,0 +1,292 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include <rapidxml_ns.hpp>
+
+#include <bimpp/svgex/validator.hpp>
+#include <bimpp/svgex/stats.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        enum class diagnostic_type
+        {
+            unknown_attribute,      // an svg attribute which svgpp does not know, it is skipped
+            unknown_css_property,   // a css property which svgpp does not know, it is skipped
+            unknown_element,        // an svg element which svgpp does not know, it is skipped
+            invalid_value,          // an svg attribute which svgpp can not parse, or which is missing, it is skipped
+            rejected_bimpp,         // a `bimpp` attribute which is not an entity, see `rejection_reason`
+            invalid_reference       // a validation issue of the loaded house, it has no location
+        };
+
+        struct diagnostic
+        {
+            static const size_t npos = static_cast<size_t>(-1);
+
+            diagnostic_type type;
+            std::string     detail;     // the name, the value, the rejection reason or the validation issue
+            size_t          offset;     // the byte offset in the svg, or `npos`
+            size_t          line;       // 1-based, or 0 without an offset
+            std::string     element;    // the name of the element, empty without an offset
+        };
+
+        inline const char* to_string(diagnostic_type _type)
+        {
+            switch (_type)
+            {
+            case diagnostic_type::unknown_attribute: return "unknown attribute";
+            case diagnostic_type::unknown_css_property: return "unknown css property";
+            case diagnostic_type::unknown_element: return "unknown element";
+            case diagnostic_type::invalid_value: return "invalid value";
+            case diagnostic_type::rejected_bimpp: return "rejected bimpp";
+            default: return "invalid reference";
+            }
+        }
+
+        inline std::string to_string(const diagnostic& _diagnostic)
+        {
+            std::string text;
+            if (_diagnostic.line > 0)
+            {
+                text = "line " + std::to_string(_diagnostic.line) + ", <" + _diagnostic.element + ">: ";
+            }
+            return text + to_string(_diagnostic.type) + " " + _diagnostic.detail;
+        }
+
+        // the lenient loading records its problems here and goes on, instead of throwing.
+        // only the first `capacity` diagnostics are kept, all of them are counted.
+        // the hot path only stores the offsets, the lines and the elements are resolved once at the end of the loading.
+        // the parsing rewrites the svg in place, so the line breaks are found before it and the elements are taken
+        // from the parsed document instead of the rewritten text.
+        class diagnostics
+        {
+        public:
+            static const bool lenient = true;
+
+            class phase_scope
+            {
+            public:
+                phase_scope(diagnostics& _diagnostics, load_phase _phase)
+                {}
+            };
+
+            explicit diagnostics(size_t _capacity = 64)
+                : capacity(_capacity)
+                , count(0)
+                , issue_count(0)
+                , svg_begin(nullptr)
+            {}
+
+            void clear()
+            {
+                entries.clear();
+                count = 0;
+                issue_count = 0;
+                svg_begin = nullptr;
+                line_break_offsets.clear();
+            }
+
+            const std::vector<diagnostic>& getEntries() const
+            {
+                return entries;
+            }
+
+            // the number of the problems, including the ones which are not kept.
+            size_t getCount() const
+            {
+                return count;
+            }
+
+            bool isTruncated() const
+            {
+                return count > entries.size();
+            }
+
+            // the number of the validation issues, the house has dangling references if it is not 0.
+            size_t getIssueCount() const
+            {
+                return issue_count;
+            }
+
+            // the hooks of the loader.
+            void setSource(const char* _svg, size_t _svg_size)
+            {
+                svg_begin = _svg;
+                line_break_offsets.clear();
+                const char* const svg_end = _svg + _svg_size;
+                for (const char* itr = _svg; (itr = static_cast<const char*>(std::memchr(itr, '\n', static_cast<size_t>(svg_end - itr)))) != nullptr; ++itr)
+                {
+                    line_break_offsets.push_back(static_cast<size_t>(itr - _svg));
+                }
+            }
+
+            void onElement() {}
+            void onBimPP() {}
+            void onEntity(entity_type _type) {}
+
+            void onRejected(rejection_reason _reason, const char* _bimpp)
+            {
+                add(diagnostic_type::rejected_bimpp, to_string(_reason), _bimpp);
+            }
+
+            void onUnknownAttribute(const char* _name, size_t _name_size)
+            {
+                // the detail is not built for a diagnostic which is only counted.
+                if (isFull())
+                {
+                    ++count;
+                    return;
+                }
+                add(diagnostic_type::unknown_attribute, std::string(_name, _name_size), _name);
+            }
+
+            void onUnknownCssProperty(const char* _location)
+            {
+                add(diagnostic_type::unknown_css_property, std::string(), _location);
+            }
+
+            void onUnknownElement(const char* _name, size_t _name_size)
+            {
+                if (isFull())
+                {
+                    ++count;
+                    return;
+                }
+                add(diagnostic_type::unknown_element, std::string(_name, _name_size), _name);
+            }
+
+            void onInvalidValue(const char* _detail, size_t _detail_size, const char* _location)
+            {
+                if (isFull())
+                {
+                    ++count;
+                    return;
+                }
+                add(diagnostic_type::invalid_value, std::string(_detail, _detail_size), _location);
+            }
+
+            void onIssue(const validation_issue& _issue)
+            {
+                ++issue_count;
+                // the detail is not built for a diagnostic which is only counted.
+                if (isFull())
+                {
+                    ++count;
+                    return;
+                }
+                add(diagnostic_type::invalid_reference, to_string(_issue), nullptr);
+            }
+
+            // fill the lines and the elements of the diagnostics. the names of the parsed document stay at their offsets,
+            // so the element of a diagnostic is the last element in the document order whose name is before its offset.
+            void resolve(const rapidxml_ns::xml_document<>& _xml_doc)
+            {
+                std::vector<size_t> order;
+                for (size_t i = 0; i < entries.size(); ++i)
+                {
+                    if (entries[i].offset != diagnostic::npos)
+                    {
+                        order.push_back(i);
+                    }
+                }
+                std::sort(order.begin(), order.end(), [this](size_t _a, size_t _b) { return entries[_a].offset < entries[_b].offset; });
+                const rapidxml_ns::xml_node<>* xml_element = nullptr;
+                const rapidxml_ns::xml_node<>* next_xml_element = findNextElement(&_xml_doc);
+                for (size_t i : order)
+                {
+                    diagnostic& entry = entries[i];
+                    entry.line = 1 + static_cast<size_t>(std::lower_bound(line_break_offsets.cbegin(), line_break_offsets.cend(), entry.offset) - line_break_offsets.cbegin());
+                    while (next_xml_element != nullptr
+                        && static_cast<size_t>(next_xml_element->name() - svg_begin) <= entry.offset)
+                    {
+                        xml_element = next_xml_element;
+                        next_xml_element = findNextElement(next_xml_element);
+                    }
+                    entry.element = xml_element != nullptr ? std::string(xml_element->name(), xml_element->name_size()) : std::string();
+                }
+            }
+
+        private:
+            // the element after `_node` in the document order.
+            static const rapidxml_ns::xml_node<>* findNextElement(const rapidxml_ns::xml_node<>* _node)
+            {
+                while (_node != nullptr)
+                {
+                    const rapidxml_ns::xml_node<>* next = _node->first_node();
+                    // the document has no siblings, it ends the walk.
+                    while (next == nullptr && _node->parent() != nullptr)
+                    {
+                        next = _node->next_sibling();
+                        _node = _node->parent();
+                    }
+                    _node = next;
+                    if (_node != nullptr
+                        && _node->type() == rapidxml_ns::node_element)
+                    {
+                        return _node;
+                    }
+                }
+                return nullptr;
+            }
+
+            bool isFull() const
+            {
+                return entries.size() >= capacity;
+            }
+
+            void add(diagnostic_type _type, const std::string& _detail, const char* _location)
+            {
+                ++count;
+                if (isFull())
+                {
+                    return;
+                }
+                diagnostic entry;
+                entry.type = _type;
+                entry.detail = _detail;
+                entry.offset = diagnostic::npos;
+                if (_location != nullptr && svg_begin != nullptr)
+                {
+                    entry.offset = static_cast<size_t>(_location - svg_begin);
+                }
+                entry.line = 0;
+                entries.push_back(std::move(entry));
+            }
+
+        private:
+            size_t                  capacity;
+            size_t                  count;
+            size_t                  issue_count;
+            const char*             svg_begin;
+            std::vector<size_t>     line_break_offsets;
+            std::vector<diagnostic> entries;
+        };
+    }
+}
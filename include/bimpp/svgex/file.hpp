@@ -0,0 +1,230 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+
+#if defined(WIN32)
+#include <process.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // read the whole file into `_content`, the capacity of `_content` is reused.
+        inline bool read_file(const std::string& _path, std::string& _content)
+        {
+            std::ifstream ifs(_path, std::ifstream::in | std::ifstream::binary);
+            if (!ifs.good())
+            {
+                return false;
+            }
+            ifs.seekg(0, std::ifstream::end);
+            const std::streamoff file_size = ifs.tellg();
+            if (file_size < 0)
+            {
+                return false;
+            }
+            ifs.seekg(0, std::ifstream::beg);
+            _content.resize(static_cast<size_t>(file_size));
+            if (file_size > 0)
+            {
+                ifs.read(&_content[0], file_size);
+            }
+            return !ifs.bad() && ifs.gcount() == file_size;
+        }
+
+        // write `_content` to a new file next to `_path`, which then replaces `_path`, so a reader sees
+        // the previous file or the whole new one. the new file is removed if a step fails.
+        inline bool replace_file(const std::string& _path, const std::string& _content)
+        {
+#if defined(WIN32)
+            static std::atomic<unsigned> temporary_count(0);
+            const std::string temporary_path = _path + "." + std::to_string(::_getpid()) + "." + std::to_string(temporary_count++) + ".tmp";
+            std::ofstream ofs(temporary_path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+            ofs.write(_content.data(), static_cast<std::streamsize>(_content.size()));
+            ofs.close();
+            if (ofs.fail()
+                || std::rename(temporary_path.c_str(), _path.c_str()) != 0)
+            {
+                std::remove(temporary_path.c_str());
+                return false;
+            }
+            return true;
+#else
+            // the name is unique, so the writers of the same path do not write in the same file.
+            std::string temporary_path = _path + ".XXXXXX";
+            const int fd = ::mkstemp(&temporary_path[0]);
+            if (fd < 0)
+            {
+                return false;
+            }
+            bool success = ::fchmod(fd, 0644) == 0;
+            const char* data = _content.data();
+            size_t remaining = _content.size();
+            while (success && remaining > 0)
+            {
+                const ssize_t written = ::write(fd, data, remaining);
+                if (written < 0)
+                {
+                    success = errno == EINTR;
+                    continue;
+                }
+                data += written;
+                remaining -= static_cast<size_t>(written);
+            }
+            // the errors of the delayed writes are reported by `close`.
+            if (::close(fd) != 0)
+            {
+                success = false;
+            }
+            if (!success
+                || ::rename(temporary_path.c_str(), _path.c_str()) != 0)
+            {
+                ::unlink(temporary_path.c_str());
+                return false;
+            }
+            return true;
+#endif
+        }
+
+        // a private copy-on-write mapping of a file, which the loader can parse in place.
+        // the mapping is always followed by a '\0', and the writes never reach the file.
+        // the file is read into the memory on the platforms without `mmap`.
+        class mapped_file
+        {
+        public:
+            mapped_file()
+                : map_data(nullptr)
+                , map_size(0)
+                , file_size(0)
+            {}
+
+            ~mapped_file()
+            {
+                close();
+            }
+
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+
+            bool open(const std::string& _path)
+            {
+                close();
+#if defined(WIN32)
+                if (!read_file(_path, content))
+                {
+                    return false;
+                }
+                file_size = content.size();
+                return true;
+#else
+                const int fd = ::open(_path.c_str(), O_RDONLY);
+                if (fd < 0)
+                {
+                    return false;
+                }
+                struct stat file_stat;
+                if (::fstat(fd, &file_stat) != 0)
+                {
+                    ::close(fd);
+                    return false;
+                }
+                const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+                file_size = static_cast<size_t>(file_stat.st_size);
+                // reserve one more byte than the file, the pages after the end of the file are zero-filled,
+                // then map the file over the start of the anonymous pages.
+                map_size = (file_size + 1 + page_size - 1) / page_size * page_size;
+                void* region = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (region == MAP_FAILED)
+                {
+                    ::close(fd);
+                    map_size = 0;
+                    file_size = 0;
+                    return false;
+                }
+                if (file_size > 0
+                    && ::mmap(region, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+                {
+                    ::munmap(region, map_size);
+                    ::close(fd);
+                    map_size = 0;
+                    file_size = 0;
+                    return false;
+                }
+                ::close(fd);
+                ::madvise(region, map_size, MADV_SEQUENTIAL);
+                map_data = static_cast<char*>(region);
+                return true;
+#endif
+            }
+
+            void close()
+            {
+#if defined(WIN32)
+                content.clear();
+#else
+                if (map_data != nullptr)
+                {
+                    ::munmap(map_data, map_size);
+                }
+#endif
+                map_data = nullptr;
+                map_size = 0;
+                file_size = 0;
+            }
+
+            char* data()
+            {
+#if defined(WIN32)
+                return &content[0];
+#else
+                return map_data;
+#endif
+            }
+
+            size_t size() const
+            {
+                return file_size;
+            }
+
+        private:
+            char*       map_data;
+            size_t      map_size;
+            size_t      file_size;
+#if defined(WIN32)
+            std::string content;
+#endif
+        };
+    }
+}
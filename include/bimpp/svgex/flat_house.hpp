@@ -0,0 +1,377 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+#include <bimpp/plan2d.hpp>
+#include <bimpp/svgex/symbol_table.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // maps the ids of one entity kind to the slots of its columns.
+        // the small dense ids are indexed by a vector, the others fall back to a hash map.
+        class id_index
+        {
+        public:
+            static const size_t npos = static_cast<size_t>(-1);
+
+            id_index()
+                : count(0)
+            {}
+
+            size_t find(size_t _id) const
+            {
+                if (_id < dense_slots.size())
+                {
+                    return dense_slots[_id];
+                }
+                std::unordered_map<size_t, size_t>::const_iterator itr = sparse_slots.find(_id);
+                if (itr == sparse_slots.cend())
+                {
+                    return npos;
+                }
+                return itr->second;
+            }
+
+            bool contains(size_t _id) const
+            {
+                return find(_id) != npos;
+            }
+
+            bool insert(size_t _id, size_t _slot)
+            {
+                if (_id >= dense_slots.size()
+                    && (_id < dense_min_size || _id < 2 * (count + 1)))
+                {
+                    growDense(_id);
+                }
+                if (_id < dense_slots.size())
+                {
+                    if (dense_slots[_id] != npos)
+                    {
+                        return false;
+                    }
+                    dense_slots[_id] = _slot;
+                }
+                else if (!sparse_slots.insert(std::make_pair(_id, _slot)).second)
+                {
+                    return false;
+                }
+                ++count;
+                return true;
+            }
+
+            size_t size() const
+            {
+                return count;
+            }
+
+            void clear()
+            {
+                dense_slots.clear();
+                sparse_slots.clear();
+                count = 0;
+            }
+
+        private:
+            void growDense(size_t _id)
+            {
+                const size_t new_size = std::max<size_t>(_id + 1, 2 * dense_slots.size());
+                dense_slots.resize(new_size, static_cast<size_t>(npos));
+                // the sparse ids covered by the new range move to the dense part.
+                for (std::unordered_map<size_t, size_t>::iterator itr = sparse_slots.begin(); itr != sparse_slots.end();)
+                {
+                    if (itr->first >= new_size)
+                    {
+                        ++itr;
+                        continue;
+                    }
+                    dense_slots[itr->first] = itr->second;
+                    itr = sparse_slots.erase(itr);
+                }
+            }
+
+        private:
+            static const size_t dense_min_size = 1024;
+
+            std::vector<size_t>                 dense_slots;
+            std::unordered_map<size_t, size_t>  sparse_slots;
+            size_t                              count;
+        };
+
+        // the structure-of-arrays storage of a house.
+        // every entity kind keeps its fields in contiguous columns in the order of loading,
+        // and its `index` maps the ids to the slots of those columns.
+        // the `kinds` and `directions` columns are ids of `symbols`.
+        template<typename TConstant = plan2d::constant<>>
+        class flat_house
+        {
+        public:
+            typedef typename TConstant::precision_type      precision_type;
+            typedef typename plan2d::node<TConstant>        node_type;
+            typedef typename plan2d::wall<TConstant>        wall_type;
+            typedef typename plan2d::hole<TConstant>        hole_type;
+            typedef typename plan2d::room<TConstant>        room_type;
+            typedef typename plan2d::house<TConstant>       house_type;
+
+            struct node_columns
+            {
+                std::vector<size_t>         ids;
+                std::vector<precision_type> xs;
+                std::vector<precision_type> ys;
+                id_index                    index;
+            };
+
+            struct wall_columns
+            {
+                std::vector<size_t>         ids;
+                std::vector<uint32_t>       kinds;
+                std::vector<size_t>         start_node_ids;
+                std::vector<size_t>         end_node_ids;
+                std::vector<precision_type> thicknesses;
+                id_index                    index;
+            };
+
+            struct hole_columns
+            {
+                std::vector<size_t>         ids;
+                std::vector<uint32_t>       kinds;
+                std::vector<uint32_t>       directions;
+                std::vector<size_t>         wall_ids;
+                std::vector<precision_type> distances;
+                std::vector<precision_type> widths;
+                id_index                    index;
+            };
+
+            struct room_columns
+            {
+                std::vector<size_t>         ids;
+                std::vector<uint32_t>       kinds;
+                // the wall ids of the room at slot `i` are `wall_ids[wall_id_offsets[i], wall_id_offsets[i + 1])`.
+                std::vector<size_t>         wall_id_offsets;
+                std::vector<size_t>         wall_ids;
+                id_index                    index;
+            };
+
+        public:
+            flat_house()
+            {
+                reset();
+            }
+
+            void reset()
+            {
+                nodes = node_columns();
+                walls = wall_columns();
+                holes = hole_columns();
+                rooms = room_columns();
+                rooms.wall_id_offsets.push_back(0);
+                symbols.clear();
+            }
+
+            bool addNode(size_t _id, precision_type _x, precision_type _y)
+            {
+                if (!nodes.index.insert(_id, nodes.ids.size()))
+                {
+                    return false;
+                }
+                nodes.ids.push_back(_id);
+                nodes.xs.push_back(_x);
+                nodes.ys.push_back(_y);
+                return true;
+            }
+
+            bool addWall(size_t _id, wall_type&& _wall)
+            {
+                if (!walls.index.insert(_id, walls.ids.size()))
+                {
+                    return false;
+                }
+                walls.ids.push_back(_id);
+                walls.kinds.push_back(symbols.intern(_wall.kind));
+                walls.start_node_ids.push_back(_wall.start_node_id);
+                walls.end_node_ids.push_back(_wall.end_node_id);
+                walls.thicknesses.push_back(_wall.thickness);
+                return true;
+            }
+
+            bool addHole(size_t _id, hole_type&& _hole)
+            {
+                if (!holes.index.insert(_id, holes.ids.size()))
+                {
+                    return false;
+                }
+                holes.ids.push_back(_id);
+                holes.kinds.push_back(symbols.intern(_hole.kind));
+                holes.directions.push_back(symbols.intern(_hole.direction));
+                holes.wall_ids.push_back(_hole.wall_id);
+                holes.distances.push_back(_hole.distance);
+                holes.widths.push_back(_hole.width);
+                return true;
+            }
+
+            bool addRoom(size_t _id, room_type&& _room)
+            {
+                if (!rooms.index.insert(_id, rooms.ids.size()))
+                {
+                    return false;
+                }
+                rooms.ids.push_back(_id);
+                rooms.kinds.push_back(symbols.intern(_room.kind));
+                rooms.wall_ids.insert(rooms.wall_ids.end(), _room.wall_ids.cbegin(), _room.wall_ids.cend());
+                rooms.wall_id_offsets.push_back(rooms.wall_ids.size());
+                return true;
+            }
+
+            wall_type getWall(size_t _slot) const
+            {
+                wall_type bim_wall;
+                getWall(_slot, bim_wall);
+                return bim_wall;
+            }
+
+            hole_type getHole(size_t _slot) const
+            {
+                hole_type bim_hole;
+                getHole(_slot, bim_hole);
+                return bim_hole;
+            }
+
+            room_type getRoom(size_t _slot) const
+            {
+                room_type bim_room;
+                getRoom(_slot, bim_room);
+                return bim_room;
+            }
+
+            // the same checks as the loader does on the maps, but as linear scans over the columns.
+            bool check() const
+            {
+                wall_type bim_wall;
+                for (size_t i = 0; i < walls.ids.size(); ++i)
+                {
+                    getWall(i, bim_wall);
+                    if (!bim_wall.isValid())
+                    {
+                        return false;
+                    }
+                    if (!nodes.index.contains(walls.start_node_ids[i])
+                        || !nodes.index.contains(walls.end_node_ids[i]))
+                    {
+                        return false;
+                    }
+                }
+
+                hole_type bim_hole;
+                for (size_t i = 0; i < holes.ids.size(); ++i)
+                {
+                    getHole(i, bim_hole);
+                    if (!bim_hole.isValid())
+                    {
+                        return false;
+                    }
+                    if (!walls.index.contains(holes.wall_ids[i]))
+                    {
+                        return false;
+                    }
+                }
+
+                for (size_t i = 0; i < rooms.ids.size(); ++i)
+                {
+                    if (rooms.wall_id_offsets[i] == rooms.wall_id_offsets[i + 1])
+                    {
+                        return false;
+                    }
+                }
+                for (size_t wall_id : rooms.wall_ids)
+                {
+                    if (!walls.index.contains(wall_id))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            void toHouse(house_type& _house) const
+            {
+                _house.reset();
+                for (size_t i = 0; i < nodes.ids.size(); ++i)
+                {
+                    _house.nodes.insert(_house.nodes.end(), std::make_pair(nodes.ids[i], node_type(nodes.xs[i], nodes.ys[i])));
+                }
+                for (size_t i = 0; i < walls.ids.size(); ++i)
+                {
+                    _house.walls.insert(_house.walls.end(), std::make_pair(walls.ids[i], getWall(i)));
+                }
+                for (size_t i = 0; i < holes.ids.size(); ++i)
+                {
+                    _house.holes.insert(_house.holes.end(), std::make_pair(holes.ids[i], getHole(i)));
+                }
+                for (size_t i = 0; i < rooms.ids.size(); ++i)
+                {
+                    _house.rooms.insert(_house.rooms.end(), std::make_pair(rooms.ids[i], getRoom(i)));
+                }
+            }
+
+            // the overloads filling an existing entity reuse the capacity of its strings and vectors.
+            void getWall(size_t _slot, wall_type& _wall) const
+            {
+                _wall.kind = symbols.getString(walls.kinds[_slot]);
+                _wall.start_node_id = walls.start_node_ids[_slot];
+                _wall.end_node_id = walls.end_node_ids[_slot];
+                _wall.thickness = walls.thicknesses[_slot];
+            }
+
+            void getHole(size_t _slot, hole_type& _hole) const
+            {
+                _hole.kind = symbols.getString(holes.kinds[_slot]);
+                _hole.direction = symbols.getString(holes.directions[_slot]);
+                _hole.wall_id = holes.wall_ids[_slot];
+                _hole.distance = holes.distances[_slot];
+                _hole.width = holes.widths[_slot];
+            }
+
+            void getRoom(size_t _slot, room_type& _room) const
+            {
+                _room.kind = symbols.getString(rooms.kinds[_slot]);
+                _room.wall_ids.assign(rooms.wall_ids.cbegin() + rooms.wall_id_offsets[_slot], rooms.wall_ids.cbegin() + rooms.wall_id_offsets[_slot + 1]);
+            }
+
+        public:
+            node_columns    nodes;
+            wall_columns    walls;
+            hole_columns    holes;
+            room_columns    rooms;
+            symbol_table    symbols;
+        };
+    }
+}
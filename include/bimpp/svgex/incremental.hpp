@@ -0,0 +1,271 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+
+#include <bimpp/plan2d.hpp>
+#include <bimpp/svgex/validator.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // the ids of one entity kind which differ from the previous loading.
+        struct entity_delta
+        {
+            std::vector<size_t> added;
+            std::vector<size_t> changed;
+            std::vector<size_t> removed;
+
+            bool empty() const
+            {
+                return added.empty() && changed.empty() && removed.empty();
+            }
+
+            size_t size() const
+            {
+                return added.size() + changed.size() + removed.size();
+            }
+
+            void clear()
+            {
+                added.clear();
+                changed.clear();
+                removed.clear();
+            }
+        };
+
+        struct house_delta
+        {
+            entity_delta    nodes;
+            entity_delta    walls;
+            entity_delta    holes;
+            entity_delta    rooms;
+            // the walls of the changed and the removed holes before the `reload`, their rooms lose an opening.
+            std::vector<size_t> previous_hole_wall_ids;
+
+            bool empty() const
+            {
+                return nodes.empty() && walls.empty() && holes.empty() && rooms.empty();
+            }
+
+            size_t size() const
+            {
+                return nodes.size() + walls.size() + holes.size() + rooms.size();
+            }
+
+            void clear()
+            {
+                nodes.clear();
+                walls.clear();
+                holes.clear();
+                rooms.clear();
+                previous_hole_wall_ids.clear();
+            }
+
+            entity_delta& get(entity_type _type)
+            {
+                switch (_type)
+                {
+                case entity_type::node: return nodes;
+                case entity_type::wall: return walls;
+                case entity_type::hole: return holes;
+                default: return rooms;
+                }
+            }
+        };
+
+        // what the previous loading decoded from the element with a given content hash.
+        struct element_record
+        {
+            element_record()
+                : has_entity(false)
+                , type(entity_type::node)
+                , id(0)
+                , generation(0)
+            {}
+
+            bool        has_entity;     // false if the element is not a valid entity
+            entity_type type;
+            size_t      id;
+            size_t      generation;     // the last loading which found the element
+        };
+
+        // the walls of every node and the rooms of every wall, whether the referenced entities exist or not.
+        // `reload` keeps it up to date, so the rooms of a delta are found without a scan of the house.
+        class house_index
+        {
+        public:
+            void clear()
+            {
+                node_walls.clear();
+                wall_rooms.clear();
+            }
+
+            template<typename TConstant>
+            void add(size_t _id, const plan2d::wall<TConstant>& _wall)
+            {
+                node_walls[_wall.start_node_id].push_back(_id);
+                if (_wall.end_node_id != _wall.start_node_id)
+                {
+                    node_walls[_wall.end_node_id].push_back(_id);
+                }
+            }
+
+            template<typename TConstant>
+            void remove(size_t _id, const plan2d::wall<TConstant>& _wall)
+            {
+                removeLink(node_walls, _wall.start_node_id, _id);
+                removeLink(node_walls, _wall.end_node_id, _id);
+            }
+
+            // the wall ids of a room are not repeated, the loader drops the repeated ones.
+            template<typename TConstant>
+            void add(size_t _id, const plan2d::room<TConstant>& _room)
+            {
+                for (size_t wall_id : _room.wall_ids)
+                {
+                    wall_rooms[wall_id].push_back(_id);
+                }
+            }
+
+            template<typename TConstant>
+            void remove(size_t _id, const plan2d::room<TConstant>& _room)
+            {
+                for (size_t wall_id : _room.wall_ids)
+                {
+                    removeLink(wall_rooms, wall_id, _id);
+                }
+            }
+
+            // the nodes and the holes are not referenced by other entities.
+            template<typename TEntity>
+            void add(size_t, const TEntity&)
+            {}
+
+            template<typename TEntity>
+            void remove(size_t, const TEntity&)
+            {}
+
+            template<typename TFunction>
+            void forEachWall(size_t _node_id, TFunction _function) const
+            {
+                forEachLink(node_walls, _node_id, _function);
+            }
+
+            template<typename TFunction>
+            void forEachRoom(size_t _wall_id, TFunction _function) const
+            {
+                forEachLink(wall_rooms, _wall_id, _function);
+            }
+
+        private:
+            typedef std::unordered_map<size_t, std::vector<size_t>> link_map;
+
+            static void removeLink(link_map& _links, size_t _key, size_t _id)
+            {
+                link_map::iterator itr = _links.find(_key);
+                if (itr == _links.end())
+                {
+                    return;
+                }
+                std::vector<size_t>& ids = itr->second;
+                std::vector<size_t>::iterator id_itr = std::find(ids.begin(), ids.end(), _id);
+                if (id_itr != ids.end())
+                {
+                    *id_itr = ids.back();
+                    ids.pop_back();
+                }
+                if (ids.empty())
+                {
+                    _links.erase(itr);
+                }
+            }
+
+            template<typename TFunction>
+            static void forEachLink(const link_map& _links, size_t _key, TFunction& _function)
+            {
+                link_map::const_iterator itr = _links.find(_key);
+                if (itr != _links.end())
+                {
+                    for (size_t id : itr->second)
+                    {
+                        _function(id);
+                    }
+                }
+            }
+
+        private:
+            link_map    node_walls;
+            link_map    wall_rooms;
+        };
+
+        // the rooms whose extended outlines depend on the delta: the added and changed rooms,
+        // and the rooms of the changed walls, of the walls of the changed nodes and of the previous and the current walls of the changed holes.
+        // `_index` is the index of the `reload` which made the delta, the cost is proportional to the delta and the rooms found.
+        template<typename TConstant>
+        void collectAffectedRooms(const plan2d::house<TConstant>& _house, const house_index& _index, const house_delta& _delta, std::vector<size_t>& _room_ids)
+        {
+            _room_ids.clear();
+            std::unordered_set<size_t> wall_ids;
+            auto add_wall = [&wall_ids](size_t _wall_id) { wall_ids.insert(_wall_id); };
+            auto add_node_walls = [&_index, &add_wall](const std::vector<size_t>& _node_ids)
+            {
+                for (size_t node_id : _node_ids)
+                {
+                    _index.forEachWall(node_id, add_wall);
+                }
+            };
+            add_node_walls(_delta.nodes.added);
+            add_node_walls(_delta.nodes.changed);
+            add_node_walls(_delta.nodes.removed);
+            wall_ids.insert(_delta.walls.added.cbegin(), _delta.walls.added.cend());
+            wall_ids.insert(_delta.walls.changed.cbegin(), _delta.walls.changed.cend());
+            wall_ids.insert(_delta.walls.removed.cbegin(), _delta.walls.removed.cend());
+            for (size_t hole_id : _delta.holes.added)
+            {
+                wall_ids.insert(_house.holes.at(hole_id).wall_id);
+            }
+            for (size_t hole_id : _delta.holes.changed)
+            {
+                wall_ids.insert(_house.holes.at(hole_id).wall_id);
+            }
+            wall_ids.insert(_delta.previous_hole_wall_ids.cbegin(), _delta.previous_hole_wall_ids.cend());
+
+            std::unordered_set<size_t> room_ids(_delta.rooms.added.cbegin(), _delta.rooms.added.cend());
+            room_ids.insert(_delta.rooms.changed.cbegin(), _delta.rooms.changed.cend());
+            auto add_room = [&room_ids](size_t _room_id) { room_ids.insert(_room_id); };
+            for (size_t wall_id : wall_ids)
+            {
+                _index.forEachRoom(wall_id, add_room);
+            }
+            _room_ids.assign(room_ids.cbegin(), room_ids.cend());
+            std::sort(_room_ids.begin(), _room_ids.end());
+        }
+    }
+}
@@ -0,0 +1,347 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include <bimpp/plan2d.hpp>
+#include <bimpp/svgex/flat_house.hpp>
+
+#ifndef M_PI
+#define M_PI       3.14159265358979323846   // pi
+#endif
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // the outlines of the rooms, all the points are kept in one arena.
+        // an outline has one or more rings, e.g. a room with a pillar inside.
+        template<typename TConstant = plan2d::constant<>>
+        class room_outlines
+        {
+        public:
+            typedef typename TConstant::precision_type      precision_type;
+
+            struct point
+            {
+                precision_type  x;
+                precision_type  y;
+            };
+
+        public:
+            // the curves are flattened to lines which are at most `_tolerance` away from them.
+            explicit room_outlines(precision_type _tolerance = static_cast<precision_type>(0.5))
+                : tolerance(_tolerance)
+            {
+                reset();
+            }
+
+            void reset()
+            {
+                ids.clear();
+                room_ring_offsets.assign(1, 0);
+                ring_point_offsets.assign(1, 0);
+                points.clear();
+                index.clear();
+            }
+
+            // `_ring_ends[i]` is the end of the ring `i` in `_points`.
+            bool addRoom(size_t _id, const point* _points, const size_t* _ring_ends, size_t _ring_count)
+            {
+                if (_ring_count == 0
+                    || !index.insert(_id, ids.size()))
+                {
+                    return false;
+                }
+                const size_t point_offset = points.size();
+                points.insert(points.end(), _points, _points + _ring_ends[_ring_count - 1]);
+                for (size_t i = 0; i < _ring_count; ++i)
+                {
+                    ring_point_offsets.push_back(point_offset + _ring_ends[i]);
+                }
+                ids.push_back(_id);
+                room_ring_offsets.push_back(ring_point_offsets.size() - 1);
+                return true;
+            }
+
+            // return the slot of the outline of the room `_room_id`, or `id_index::npos`.
+            size_t find(size_t _room_id) const
+            {
+                return index.find(_room_id);
+            }
+
+            size_t getRingCount(size_t _slot) const
+            {
+                return room_ring_offsets[_slot + 1] - room_ring_offsets[_slot];
+            }
+
+            std::pair<const point*, const point*> getRing(size_t _slot, size_t _ring) const
+            {
+                const size_t ring = room_ring_offsets[_slot] + _ring;
+                return std::make_pair(points.data() + ring_point_offsets[ring], points.data() + ring_point_offsets[ring + 1]);
+            }
+
+        public:
+            precision_type      tolerance;
+            std::vector<size_t> ids;
+            // the rings of the outline at slot `i` are `[room_ring_offsets[i], room_ring_offsets[i + 1])`.
+            std::vector<size_t> room_ring_offsets;
+            // the points of the ring `r` are `points[ring_point_offsets[r], ring_point_offsets[r + 1])`.
+            std::vector<size_t> ring_point_offsets;
+            std::vector<point>  points;
+            id_index            index;
+        };
+
+        // builds the rings of one svg path from absolute path commands, the curves are flattened on the fly.
+        template<typename TConstant = plan2d::constant<>>
+        class outline_builder
+        {
+        public:
+            typedef typename TConstant::precision_type              precision_type;
+            typedef typename room_outlines<TConstant>::point        point;
+
+        public:
+            outline_builder()
+                : tolerance(0.5)
+                , current_x(0.0)
+                , current_y(0.0)
+                , start_x(0.0)
+                , start_y(0.0)
+            {}
+
+            // the capacity is kept for the next path.
+            void clear()
+            {
+                points.clear();
+                ring_ends.clear();
+            }
+
+            void setTolerance(double _tolerance)
+            {
+                tolerance = _tolerance > 0.0 ? _tolerance : 0.5;
+            }
+
+            void moveTo(double _x, double _y)
+            {
+                closeRing();
+                start_x = _x;
+                start_y = _y;
+                addPoint(_x, _y);
+            }
+
+            void lineTo(double _x, double _y)
+            {
+                beginRing();
+                addPoint(_x, _y);
+            }
+
+            void cubicTo(double _x1, double _y1, double _x2, double _y2, double _x, double _y)
+            {
+                beginRing();
+                const double x0 = current_x;
+                const double y0 = current_y;
+                // the segment count of wang's formula for a cubic bezier.
+                const double dx = std::max(std::abs(x0 - 2.0 * _x1 + _x2), std::abs(_x1 - 2.0 * _x2 + _x));
+                const double dy = std::max(std::abs(y0 - 2.0 * _y1 + _y2), std::abs(_y1 - 2.0 * _y2 + _y));
+                const size_t count = getSegmentCount(std::sqrt(0.75 * std::sqrt(dx * dx + dy * dy) / tolerance));
+                for (size_t i = 1; i < count; ++i)
+                {
+                    const double t = static_cast<double>(i) / count;
+                    const double s = 1.0 - t;
+                    const double a = s * s * s;
+                    const double b = 3.0 * s * s * t;
+                    const double c = 3.0 * s * t * t;
+                    const double d = t * t * t;
+                    addPoint(a * x0 + b * _x1 + c * _x2 + d * _x, a * y0 + b * _y1 + c * _y2 + d * _y);
+                }
+                addPoint(_x, _y);
+            }
+
+            void quadraticTo(double _x1, double _y1, double _x, double _y)
+            {
+                beginRing();
+                const double x0 = current_x;
+                const double y0 = current_y;
+                const double dx = x0 - 2.0 * _x1 + _x;
+                const double dy = y0 - 2.0 * _y1 + _y;
+                const size_t count = getSegmentCount(std::sqrt(0.25 * std::sqrt(dx * dx + dy * dy) / tolerance));
+                for (size_t i = 1; i < count; ++i)
+                {
+                    const double t = static_cast<double>(i) / count;
+                    const double s = 1.0 - t;
+                    addPoint(s * s * x0 + 2.0 * s * t * _x1 + t * t * _x, s * s * y0 + 2.0 * s * t * _y1 + t * t * _y);
+                }
+                addPoint(_x, _y);
+            }
+
+            // the endpoint parameterization of svg is converted to the center parameterization first.
+            void arcTo(double _rx, double _ry, double _x_axis_rotation, bool _large_arc_flag, bool _sweep_flag, double _x, double _y)
+            {
+                beginRing();
+                const double x0 = current_x;
+                const double y0 = current_y;
+                double rx = std::abs(_rx);
+                double ry = std::abs(_ry);
+                if (rx == 0.0
+                    || ry == 0.0
+                    || (x0 == _x && y0 == _y))
+                {
+                    addPoint(_x, _y);
+                    return;
+                }
+                const double phi = _x_axis_rotation * M_PI / 180.0;
+                const double cos_phi = std::cos(phi);
+                const double sin_phi = std::sin(phi);
+                const double hx = (x0 - _x) / 2.0;
+                const double hy = (y0 - _y) / 2.0;
+                const double x1 = cos_phi * hx + sin_phi * hy;
+                const double y1 = -sin_phi * hx + cos_phi * hy;
+                const double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+                if (lambda > 1.0)
+                {
+                    rx *= std::sqrt(lambda);
+                    ry *= std::sqrt(lambda);
+                }
+                const double numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+                const double denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+                double coefficient = denominator > 0.0 ? std::sqrt(std::max(0.0, numerator / denominator)) : 0.0;
+                if (_large_arc_flag == _sweep_flag)
+                {
+                    coefficient = -coefficient;
+                }
+                const double cx1 = coefficient * rx * y1 / ry;
+                const double cy1 = -coefficient * ry * x1 / rx;
+                const double cx = cos_phi * cx1 - sin_phi * cy1 + (x0 + _x) / 2.0;
+                const double cy = sin_phi * cx1 + cos_phi * cy1 + (y0 + _y) / 2.0;
+                const double theta = std::atan2((y1 - cy1) / ry, (x1 - cx1) / rx);
+                double delta = std::atan2((-y1 - cy1) / ry, (-x1 - cx1) / rx) - theta;
+                if (_sweep_flag && delta < 0.0)
+                {
+                    delta += 2.0 * M_PI;
+                }
+                else if (!_sweep_flag && delta > 0.0)
+                {
+                    delta -= 2.0 * M_PI;
+                }
+                // the largest angle step whose chord is within the tolerance.
+                const double radius = std::max(rx, ry);
+                const double step = radius > tolerance ? 2.0 * std::acos(1.0 - tolerance / radius) : M_PI;
+                const size_t count = getSegmentCount(std::abs(delta) / step);
+                for (size_t i = 1; i < count; ++i)
+                {
+                    const double angle = theta + delta * i / count;
+                    const double ex = rx * std::cos(angle);
+                    const double ey = ry * std::sin(angle);
+                    addPoint(cx + cos_phi * ex - sin_phi * ey, cy + sin_phi * ex + cos_phi * ey);
+                }
+                addPoint(_x, _y);
+            }
+
+            void closeSubpath()
+            {
+                closeRing();
+                current_x = start_x;
+                current_y = start_y;
+            }
+
+            void finish()
+            {
+                closeRing();
+            }
+
+            const point* getPoints() const
+            {
+                return points.data();
+            }
+
+            const size_t* getRingEnds() const
+            {
+                return ring_ends.data();
+            }
+
+            size_t getRingCount() const
+            {
+                return ring_ends.size();
+            }
+
+        private:
+            static size_t getSegmentCount(double _count)
+            {
+                if (!(_count > 1.0))
+                {
+                    return 1;
+                }
+                return static_cast<size_t>(std::ceil(std::min(_count, 1024.0)));
+            }
+
+            size_t getRingBegin() const
+            {
+                return ring_ends.empty() ? 0 : ring_ends.back();
+            }
+
+            // a drawing command after `closeSubpath` starts a new ring at the start of the closed one.
+            void beginRing()
+            {
+                if (points.size() == getRingBegin())
+                {
+                    addPoint(current_x, current_y);
+                }
+            }
+
+            // the rings of less than 3 points have no area and are dropped.
+            void closeRing()
+            {
+                const size_t ring_begin = getRingBegin();
+                if (points.size() - ring_begin < 3)
+                {
+                    points.resize(ring_begin);
+                    return;
+                }
+                ring_ends.push_back(points.size());
+            }
+
+            void addPoint(double _x, double _y)
+            {
+                current_x = _x;
+                current_y = _y;
+                point new_point;
+                new_point.x = static_cast<precision_type>(_x);
+                new_point.y = static_cast<precision_type>(_y);
+                points.push_back(new_point);
+            }
+
+        private:
+            double              tolerance;
+            double              current_x;
+            double              current_y;
+            double              start_x;
+            double              start_y;
+            std::vector<point>  points;
+            std::vector<size_t> ring_ends;
+        };
+    }
+}
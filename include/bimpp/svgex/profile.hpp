@@ -0,0 +1,75 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <boost/mpl/set.hpp>
+#include <boost/mpl/pair.hpp>
+#include <svgpp/svgpp.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // the processing profiles of `loader`, they select at compile time what is decoded besides the `bimpp` attributes.
+        namespace profile
+        {
+            // only the `bimpp` attributes, the xml DOM is walked directly and svgpp is not used at all.
+            struct metadata
+            {
+                static const bool use_svgpp = false;
+                static const bool geometry = false;
+
+                typedef boost::mpl::set<>::type processed_attributes;
+            };
+
+            // the `bimpp` attributes and the outlines of the paths.
+            struct metadata_geometry
+            {
+                static const bool use_svgpp = true;
+                static const bool geometry = true;
+
+                typedef boost::mpl::set<
+                    boost::mpl::pair<svgpp::tag::element::path, svgpp::tag::attribute::d>
+                >::type processed_attributes;
+            };
+
+            // every attribute which svgex knows, including the coordinates of the lines and the circles.
+            struct full
+            {
+                static const bool use_svgpp = true;
+                static const bool geometry = true;
+
+                typedef boost::mpl::set<
+                    boost::mpl::pair<svgpp::tag::element::circle, svgpp::tag::attribute::cx>,
+                    boost::mpl::pair<svgpp::tag::element::circle, svgpp::tag::attribute::cy>,
+                    boost::mpl::pair<svgpp::tag::element::circle, svgpp::tag::attribute::r>,
+                    boost::mpl::pair<svgpp::tag::element::line, svgpp::tag::attribute::x1>,
+                    boost::mpl::pair<svgpp::tag::element::line, svgpp::tag::attribute::y1>,
+                    boost::mpl::pair<svgpp::tag::element::line, svgpp::tag::attribute::x2>,
+                    boost::mpl::pair<svgpp::tag::element::line, svgpp::tag::attribute::y2>,
+                    boost::mpl::pair<svgpp::tag::element::path, svgpp::tag::attribute::d>
+                >::type processed_attributes;
+            };
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+#if defined(WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // the frames of `svgex --daemon`, over a unix socket or stdin and stdout.
+        // a client may send many requests without waiting, every response carries the id of its request
+        // and the responses may come in any order. the layout is native, like the one of `house_cache`.
+        struct frame_header
+        {
+            char        magic[4];       // "BXQ1" for a request, "BXR1" for a response
+            uint32_t    code;           // the `request_flag`s of a request, the `response_status` of a response
+            uint64_t    request_id;     // chosen by the client
+            uint64_t    payload_size;
+        };
+
+        // the payload of a request is the svg, or its path with `request_path`.
+        enum request_flag : uint32_t
+        {
+            request_check = 1u << 0,    // check the references of the house
+            request_rooms = 1u << 1,    // run `computeRoomExs` on the house
+            request_path = 1u << 2      // the payload is the path of an svg file which the daemon can read
+        };
+
+        enum class response_status : uint32_t
+        {
+            ok,             // the payload is a `response_body` followed by the house in the layout of `house_cache`
+            failed,         // the payload is the error
+            bad_request     // the frame is not a request, the connection is closed after this response
+        };
+
+        struct response_body
+        {
+            uint64_t    source_hash;    // the `hashSource` of the svg, which opens the house with `house_cache::open`
+            uint32_t    room_status;    // 1 if `computeRoomExs` was requested and succeeded
+            uint32_t    reserved;
+            uint64_t    room_ex_count;
+        };
+
+        static const char request_magic[4] = { 'B', 'X', 'Q', '1' };
+        static const char response_magic[4] = { 'B', 'X', 'R', '1' };
+
+        // retry the interrupted and the partial reads, false at the end of the stream or on an error.
+        inline bool read_fully(int _fd, void* _data, size_t _size)
+        {
+            char* data = static_cast<char*>(_data);
+            while (_size > 0)
+            {
+#if defined(WIN32)
+                const int count = ::_read(_fd, data, static_cast<unsigned int>(std::min<size_t>(_size, 1u << 30)));
+#else
+                const ssize_t count = ::read(_fd, data, _size);
+#endif
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count <= 0)
+                {
+                    return false;
+                }
+                data += count;
+                _size -= static_cast<size_t>(count);
+            }
+            return true;
+        }
+
+        inline bool write_fully(int _fd, const void* _data, size_t _size)
+        {
+            const char* data = static_cast<const char*>(_data);
+            while (_size > 0)
+            {
+#if defined(WIN32)
+                const int count = ::_write(_fd, data, static_cast<unsigned int>(std::min<size_t>(_size, 1u << 30)));
+#else
+                const ssize_t count = ::write(_fd, data, _size);
+#endif
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count <= 0)
+                {
+                    return false;
+                }
+                data += count;
+                _size -= static_cast<size_t>(count);
+            }
+            return true;
+        }
+
+        // read a frame, the capacity of `_payload` is reused. the payloads over `_max_payload_size` are refused.
+        inline bool read_frame(int _fd, frame_header& _header, std::string& _payload, uint64_t _max_payload_size = uint64_t(1) << 32)
+        {
+            if (!read_fully(_fd, &_header, sizeof(_header))
+                || _header.payload_size > _max_payload_size)
+            {
+                return false;
+            }
+            _payload.resize(static_cast<size_t>(_header.payload_size));
+            return _payload.empty() || read_fully(_fd, &_payload[0], _payload.size());
+        }
+
+        inline frame_header make_frame_header(const char (&_magic)[4], uint32_t _code, uint64_t _request_id, uint64_t _payload_size)
+        {
+            frame_header header;
+            std::memcpy(header.magic, _magic, sizeof(header.magic));
+            header.code = _code;
+            header.request_id = _request_id;
+            header.payload_size = _payload_size;
+            return header;
+        }
+
+        inline bool is_frame(const frame_header& _header, const char (&_magic)[4])
+        {
+            return std::memcmp(_header.magic, _magic, sizeof(_header.magic)) == 0;
+        }
+    }
+}
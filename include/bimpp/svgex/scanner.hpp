@@ -0,0 +1,459 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // the 64 bits FNV-1a hash of the content of an element, `_hash` continues the hash of a previous content.
+        inline uint64_t hashContent(const char* _data, size_t _size, uint64_t _hash = 14695981039346656037ull)
+        {
+            for (size_t i = 0; i < _size; ++i)
+            {
+                _hash ^= static_cast<unsigned char>(_data[i]);
+                _hash *= 1099511628211ull;
+            }
+            return _hash;
+        }
+
+        // finds the `bimpp` attributes of the elements which `loader::load` decodes without building a DOM:
+        // the `circle`, `line` and `path` children of the root `svg`, the other elements and their descendants are skipped.
+        // the input can be scanned in chunks, a construct which is cut by the end of a chunk
+        // is not consumed and has to be scanned again with the following data.
+        class bimpp_scanner
+        {
+        public:
+            // the geometry of the elements is only hashed if `_hash_geometry` is true.
+            explicit bimpp_scanner(bool _hash_geometry = false)
+                : root_found(false)
+                , hash_geometry(_hash_geometry)
+                , depth(0)
+            {}
+
+            // scan the complete constructs of `[_begin, _end)` and return the first byte which is not consumed,
+            // or nullptr if the svg is malformed. `_end` is the end of the input if `_final` is true.
+            // `_callback(char* _bimpp, size_t _bimpp_size, uint64_t _geometry_hash)` gets the `bimpp` attribute of every decoded element,
+            // the value is unescaped and terminated by '\0' in place. `_geometry_hash` is the `hashContent` of the names
+            // and the values of the geometry attributes of the tag, e.g. `d` or `cx`.
+            template<typename TCallback>
+            char* scan(char* _begin, char* _end, bool _final, TCallback& _callback)
+            {
+                char* p = _begin;
+                while (p < _end)
+                {
+                    char* tag_begin = static_cast<char*>(std::memchr(p, '<', _end - p));
+                    if (tag_begin == nullptr)
+                    {
+                        return _end;
+                    }
+                    char* next = nullptr;
+                    if (startsWith(tag_begin, _end, "<!--"))
+                    {
+                        next = findText(tag_begin + 4, _end, "-->");
+                    }
+                    else if (startsWith(tag_begin, _end, "<![CDATA["))
+                    {
+                        next = findText(tag_begin + 9, _end, "]]>");
+                    }
+                    else if (startsWith(tag_begin, _end, "<?"))
+                    {
+                        next = findText(tag_begin + 2, _end, "?>");
+                    }
+                    else if (startsWith(tag_begin, _end, "<!"))
+                    {
+                        next = findDeclarationEnd(tag_begin + 2, _end);
+                    }
+                    else if (startsWith(tag_begin, _end, "</"))
+                    {
+                        next = findText(tag_begin + 2, _end, ">");
+                        if (next != nullptr
+                            && depth > 0)
+                        {
+                            --depth;
+                        }
+                    }
+                    else
+                    {
+                        next = findTagEnd(tag_begin + 1, _end);
+                        if (next != nullptr
+                            && !scanStartTag(tag_begin + 1, next - 1, _callback))
+                        {
+                            return nullptr;
+                        }
+                    }
+                    if (next == nullptr)
+                    {
+                        if (_final)
+                        {
+                            error = "unexpected end of the svg";
+                            return nullptr;
+                        }
+                        return tag_begin;
+                    }
+                    p = next;
+                }
+                return p;
+            }
+
+            // true if the root element is `svg`.
+            bool hasRoot() const
+            {
+                return root_found;
+            }
+
+            const std::string& getError() const
+            {
+                return error;
+            }
+
+        private:
+            static bool isSpace(char _c)
+            {
+                return _c == ' ' || _c == '\t' || _c == '\n' || _c == '\r';
+            }
+
+            static bool startsWith(const char* _begin, const char* _end, const char* _prefix)
+            {
+                const size_t prefix_size = std::strlen(_prefix);
+                return static_cast<size_t>(_end - _begin) >= prefix_size
+                    && std::memcmp(_begin, _prefix, prefix_size) == 0;
+            }
+
+            // the local name of `[_begin, _end)` is `_local_name`, with or without a prefix.
+            static bool hasLocalName(const char* _begin, const char* _end, const char* _local_name)
+            {
+                const size_t local_name_size = std::strlen(_local_name);
+                const size_t name_size = static_cast<size_t>(_end - _begin);
+                return name_size >= local_name_size
+                    && std::memcmp(_end - local_name_size, _local_name, local_name_size) == 0
+                    && (name_size == local_name_size || *(_end - local_name_size - 1) == ':');
+            }
+
+            static bool isGeometryAttribute(const char* _name, size_t _name_size)
+            {
+                static const char* const geometry_names[] = { "d", "cx", "cy", "r", "x1", "y1", "x2", "y2", "transform" };
+                for (const char* geometry_name : geometry_names)
+                {
+                    if (_name_size == std::strlen(geometry_name)
+                        && std::memcmp(_name, geometry_name, _name_size) == 0)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // return the byte after `_text`.
+            static char* findText(char* _begin, char* _end, const char* _text)
+            {
+                const size_t text_size = std::strlen(_text);
+                for (char* p = _begin; static_cast<size_t>(_end - p) >= text_size; ++p)
+                {
+                    p = static_cast<char*>(std::memchr(p, _text[0], _end - p));
+                    if (p == nullptr
+                        || static_cast<size_t>(_end - p) < text_size)
+                    {
+                        return nullptr;
+                    }
+                    if (std::memcmp(p, _text, text_size) == 0)
+                    {
+                        return p + text_size;
+                    }
+                }
+                return nullptr;
+            }
+
+            // `<!DOCTYPE ... [ ... ]>`, the internal subset may contain '>'.
+            static char* findDeclarationEnd(char* _begin, char* _end)
+            {
+                int depth = 0;
+                char quote = 0;
+                for (char* p = _begin; p < _end; ++p)
+                {
+                    if (quote != 0)
+                    {
+                        quote = *p == quote ? 0 : quote;
+                    }
+                    else if (*p == '\'' || *p == '"')
+                    {
+                        quote = *p;
+                    }
+                    else if (*p == '[')
+                    {
+                        ++depth;
+                    }
+                    else if (*p == ']')
+                    {
+                        --depth;
+                    }
+                    else if (*p == '>' && depth <= 0)
+                    {
+                        return p + 1;
+                    }
+                }
+                return nullptr;
+            }
+
+            // return the byte after the '>' of a start tag, the attribute values may contain '>'.
+            static char* findTagEnd(char* _begin, char* _end)
+            {
+                char quote = 0;
+                for (char* p = _begin; p < _end; ++p)
+                {
+                    if (quote != 0)
+                    {
+                        quote = *p == quote ? 0 : quote;
+                    }
+                    else if (*p == '\'' || *p == '"')
+                    {
+                        quote = *p;
+                    }
+                    else if (*p == '>')
+                    {
+                        return p + 1;
+                    }
+                }
+                return nullptr;
+            }
+
+            // `[_begin, _end)` is the start tag between '<' and '>'.
+            template<typename TCallback>
+            bool scanStartTag(char* _begin, char* _end, TCallback& _callback)
+            {
+                char* p = _begin;
+                while (p < _end && !isSpace(*p) && *p != '/')
+                {
+                    ++p;
+                }
+                if (!root_found)
+                {
+                    if (!hasLocalName(_begin, p, "svg"))
+                    {
+                        error = "the root element is not svg";
+                        return false;
+                    }
+                    root_found = true;
+                }
+                // the same elements as the traversal of `loader::load`.
+                const bool decoded = depth == 1
+                    && (hasLocalName(_begin, p, "circle") || hasLocalName(_begin, p, "line") || hasLocalName(_begin, p, "path"));
+                if (_end == _begin || *(_end - 1) != '/')
+                {
+                    ++depth;
+                }
+
+                char* bimpp_value = nullptr;
+                size_t bimpp_size = 0;
+                uint64_t geometry_hash = hashContent(nullptr, 0);
+                for (;;)
+                {
+                    while (p < _end && isSpace(*p))
+                    {
+                        ++p;
+                    }
+                    if (p >= _end || *p == '/')
+                    {
+                        break;
+                    }
+                    char* name_begin = p;
+                    while (p < _end && *p != '=' && !isSpace(*p))
+                    {
+                        ++p;
+                    }
+                    char* name_end = p;
+                    while (p < _end && isSpace(*p))
+                    {
+                        ++p;
+                    }
+                    if (p >= _end || *p != '=')
+                    {
+                        error = "the attribute has no value";
+                        return false;
+                    }
+                    ++p;
+                    while (p < _end && isSpace(*p))
+                    {
+                        ++p;
+                    }
+                    if (p >= _end || (*p != '\'' && *p != '"'))
+                    {
+                        error = "the attribute value is not quoted";
+                        return false;
+                    }
+                    const char quote = *p++;
+                    char* value_begin = p;
+                    char* value_end = static_cast<char*>(std::memchr(p, quote, _end - p));
+                    if (value_end == nullptr)
+                    {
+                        error = "the attribute value is not closed";
+                        return false;
+                    }
+                    p = value_end + 1;
+                    if (!decoded)
+                    {
+                        continue;
+                    }
+                    if (name_end - name_begin == 5
+                        && std::memcmp(name_begin, "bimpp", 5) == 0
+                        && bimpp_value == nullptr)
+                    {
+                        char* unescaped_end = unescape(value_begin, value_end);
+                        *unescaped_end = '\0';
+                        bimpp_value = value_begin;
+                        bimpp_size = static_cast<size_t>(unescaped_end - value_begin);
+                    }
+                    else if (hash_geometry
+                        && isGeometryAttribute(name_begin, name_end - name_begin))
+                    {
+                        // `name=value"`, the name has no '=' and the value has no closing quote, so the pairs are not ambiguous.
+                        geometry_hash = hashContent(name_begin, name_end - name_begin, geometry_hash);
+                        geometry_hash = hashContent("=", 1, geometry_hash);
+                        geometry_hash = hashContent(value_begin, value_end - value_begin + 1, geometry_hash);
+                    }
+                }
+                // the geometry after the `bimpp` attribute is hashed too.
+                if (bimpp_value != nullptr)
+                {
+                    _callback(bimpp_value, bimpp_size, geometry_hash);
+                }
+                return true;
+            }
+
+            // translate the xml entities in place and return the new end.
+            static char* unescape(char* _begin, char* _end)
+            {
+                char* out = _begin;
+                for (char* p = _begin; p < _end;)
+                {
+                    if (*p != '&')
+                    {
+                        *out++ = *p++;
+                        continue;
+                    }
+                    char* semicolon = static_cast<char*>(std::memchr(p, ';', _end - p));
+                    if (semicolon == nullptr)
+                    {
+                        *out++ = *p++;
+                        continue;
+                    }
+                    const char* entity = p + 1;
+                    const size_t entity_size = semicolon - entity;
+                    if (entity_size == 2 && std::memcmp(entity, "lt", 2) == 0)
+                    {
+                        *out++ = '<';
+                    }
+                    else if (entity_size == 2 && std::memcmp(entity, "gt", 2) == 0)
+                    {
+                        *out++ = '>';
+                    }
+                    else if (entity_size == 3 && std::memcmp(entity, "amp", 3) == 0)
+                    {
+                        *out++ = '&';
+                    }
+                    else if (entity_size == 4 && std::memcmp(entity, "quot", 4) == 0)
+                    {
+                        *out++ = '"';
+                    }
+                    else if (entity_size == 4 && std::memcmp(entity, "apos", 4) == 0)
+                    {
+                        *out++ = '\'';
+                    }
+                    else if (entity_size > 1 && entity[0] == '#')
+                    {
+                        const bool hex = entity[1] == 'x';
+                        unsigned long code = 0;
+                        for (const char* d = entity + (hex ? 2 : 1); d < semicolon; ++d)
+                        {
+                            const int digit = *d >= '0' && *d <= '9' ? *d - '0'
+                                : hex && *d >= 'a' && *d <= 'f' ? *d - 'a' + 10
+                                : hex && *d >= 'A' && *d <= 'F' ? *d - 'A' + 10
+                                : -1;
+                            if (digit < 0)
+                            {
+                                code = 0x110000;
+                                break;
+                            }
+                            code = code * (hex ? 16 : 10) + digit;
+                            if (code >= 0x110000)
+                            {
+                                break;
+                            }
+                        }
+                        if (code == 0 || code >= 0x110000)
+                        {
+                            *out++ = *p++;
+                            continue;
+                        }
+                        out = encodeUtf8(code, out);
+                    }
+                    else
+                    {
+                        *out++ = *p++;
+                        continue;
+                    }
+                    p = semicolon + 1;
+                }
+                return out;
+            }
+
+            // the utf-8 sequence is never longer than the entity it replaces.
+            static char* encodeUtf8(unsigned long _code, char* _out)
+            {
+                if (_code < 0x80)
+                {
+                    *_out++ = static_cast<char>(_code);
+                }
+                else if (_code < 0x800)
+                {
+                    *_out++ = static_cast<char>(0xC0 | (_code >> 6));
+                    *_out++ = static_cast<char>(0x80 | (_code & 0x3F));
+                }
+                else if (_code < 0x10000)
+                {
+                    *_out++ = static_cast<char>(0xE0 | (_code >> 12));
+                    *_out++ = static_cast<char>(0x80 | ((_code >> 6) & 0x3F));
+                    *_out++ = static_cast<char>(0x80 | (_code & 0x3F));
+                }
+                else
+                {
+                    *_out++ = static_cast<char>(0xF0 | (_code >> 18));
+                    *_out++ = static_cast<char>(0x80 | ((_code >> 12) & 0x3F));
+                    *_out++ = static_cast<char>(0x80 | ((_code >> 6) & 0x3F));
+                    *_out++ = static_cast<char>(0x80 | (_code & 0x3F));
+                }
+                return _out;
+            }
+
+        private:
+            bool        root_found;
+            bool        hash_geometry;
+            size_t      depth;          // the depth of the next start tag, 0 for the root
+            std::string error;
+        };
+    }
+}
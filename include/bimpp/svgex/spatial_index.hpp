@@ -0,0 +1,536 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <bimpp/plan2d.hpp>
+#include <bimpp/svgex/flat_house.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // a uniform grid over the nodes and the walls of a house, for the box, nearest and snap queries.
+        // it is bulk loaded once: the items of every cell are contiguous, the nodes keep their coordinates
+        // in the cell order, and the walls are registered in every cell which their segment crosses.
+        // the walls are their center lines, from the start node to the end node, their thickness is ignored.
+        template<typename TConstant = plan2d::constant<>>
+        class spatial_index
+        {
+        public:
+            typedef typename TConstant::precision_type      precision_type;
+            typedef typename plan2d::house<TConstant>       house_type;
+            typedef flat_house<TConstant>                   flat_house_type;
+
+            static const size_t npos = static_cast<size_t>(-1);
+
+            struct wall_segment
+            {
+                size_t          id;
+                precision_type  x0;
+                precision_type  y0;
+                precision_type  x1;
+                precision_type  y1;
+            };
+
+        public:
+            spatial_index()
+            {
+                clear();
+            }
+
+            void clear()
+            {
+                origin_x = 0;
+                origin_y = 0;
+                cell_size = 1;
+                column_count = 0;
+                row_count = 0;
+                node_ids.clear();
+                node_xs.clear();
+                node_ys.clear();
+                node_cell_offsets.clear();
+                walls.clear();
+                wall_cell_offsets.clear();
+                wall_cell_items.clear();
+            }
+
+            // the cell size is chosen from the bounds and the counts if `_cell_size` is 0.
+            // the walls whose nodes do not exist are not indexed.
+            void build(const house_type& _house, precision_type _cell_size = 0)
+            {
+                std::vector<size_t> ids;
+                std::vector<precision_type> xs;
+                std::vector<precision_type> ys;
+                ids.reserve(_house.nodes.size());
+                xs.reserve(_house.nodes.size());
+                ys.reserve(_house.nodes.size());
+                for (const auto& node_pair : _house.nodes)
+                {
+                    ids.push_back(node_pair.first);
+                    xs.push_back(node_pair.second.x);
+                    ys.push_back(node_pair.second.y);
+                }
+                std::vector<wall_segment> segments;
+                segments.reserve(_house.walls.size());
+                for (const auto& wall_pair : _house.walls)
+                {
+                    const auto start_itr = _house.nodes.find(wall_pair.second.start_node_id);
+                    const auto end_itr = _house.nodes.find(wall_pair.second.end_node_id);
+                    if (start_itr == _house.nodes.cend() || end_itr == _house.nodes.cend())
+                    {
+                        continue;
+                    }
+                    segments.push_back(wall_segment{ wall_pair.first, start_itr->second.x, start_itr->second.y, end_itr->second.x, end_itr->second.y });
+                }
+                bulkLoad(ids, xs, ys, segments, _cell_size);
+            }
+
+            void build(const flat_house_type& _house, precision_type _cell_size = 0)
+            {
+                const typename flat_house_type::node_columns& nodes = _house.nodes;
+                const typename flat_house_type::wall_columns& house_walls = _house.walls;
+                std::vector<wall_segment> segments;
+                segments.reserve(house_walls.ids.size());
+                for (size_t i = 0; i < house_walls.ids.size(); ++i)
+                {
+                    const size_t start_slot = nodes.index.find(house_walls.start_node_ids[i]);
+                    const size_t end_slot = nodes.index.find(house_walls.end_node_ids[i]);
+                    if (start_slot == id_index::npos || end_slot == id_index::npos)
+                    {
+                        continue;
+                    }
+                    segments.push_back(wall_segment{ house_walls.ids[i], nodes.xs[start_slot], nodes.ys[start_slot], nodes.xs[end_slot], nodes.ys[end_slot] });
+                }
+                bulkLoad(nodes.ids, nodes.xs, nodes.ys, segments, _cell_size);
+            }
+
+            bool empty() const
+            {
+                return column_count == 0;
+            }
+
+            size_t getNodeCount() const { return node_ids.size(); }
+            size_t getWallCount() const { return walls.size(); }
+            size_t getColumnCount() const { return column_count; }
+            size_t getRowCount() const { return row_count; }
+            size_t getWallCellCount() const { return wall_cell_items.size(); }
+            precision_type getCellSize() const { return cell_size; }
+
+            // the ids of the walls which cross the box, in no particular order.
+            void findWalls(precision_type _min_x, precision_type _min_y, precision_type _max_x, precision_type _max_y, std::vector<size_t>& _wall_ids) const
+            {
+                _wall_ids.clear();
+                if (empty() || _min_x > _max_x || _min_y > _max_y)
+                {
+                    return;
+                }
+                const size_t first_column = getColumn(_min_x);
+                const size_t last_column = getColumn(_max_x);
+                const size_t first_row = getRow(_min_y);
+                const size_t last_row = getRow(_max_y);
+                for (size_t row = first_row; row <= last_row; ++row)
+                {
+                    for (size_t column = first_column; column <= last_column; ++column)
+                    {
+                        const size_t cell = row * column_count + column;
+                        for (size_t k = wall_cell_offsets[cell]; k < wall_cell_offsets[cell + 1]; ++k)
+                        {
+                            const uint32_t item = wall_cell_items[k];
+                            const wall_segment& segment = walls[item];
+                            // the cells of a wall are a staircase from its start to its end, so its cells in the box
+                            // follow each other. it is only reported by the first of them, whose previous cell
+                            // along the wall is outside of the box or does not list it.
+                            const bool backward_x = segment.x1 < segment.x0;
+                            const bool backward_y = segment.y1 < segment.y0;
+                            if ((column != (backward_x ? last_column : first_column)
+                                    && isListed(row * column_count + (backward_x ? column + 1 : column - 1), item))
+                                || (row != (backward_y ? last_row : first_row)
+                                    && isListed((backward_y ? row + 1 : row - 1) * column_count + column, item)))
+                            {
+                                continue;
+                            }
+                            if (intersects(segment, _min_x, _min_y, _max_x, _max_y))
+                            {
+                                _wall_ids.push_back(segment.id);
+                            }
+                        }
+                    }
+                }
+            }
+
+            // the ids of the nodes in the box, in no particular order.
+            void findNodes(precision_type _min_x, precision_type _min_y, precision_type _max_x, precision_type _max_y, std::vector<size_t>& _node_ids) const
+            {
+                _node_ids.clear();
+                if (empty() || _min_x > _max_x || _min_y > _max_y)
+                {
+                    return;
+                }
+                const size_t first_column = getColumn(_min_x);
+                const size_t last_column = getColumn(_max_x);
+                for (size_t row = getRow(_min_y), last_row = getRow(_max_y); row <= last_row; ++row)
+                {
+                    // the cells of a row are contiguous, so are their nodes.
+                    const size_t begin = node_cell_offsets[row * column_count + first_column];
+                    const size_t end = node_cell_offsets[row * column_count + last_column + 1];
+                    for (size_t k = begin; k < end; ++k)
+                    {
+                        if (node_xs[k] >= _min_x && node_xs[k] <= _max_x
+                            && node_ys[k] >= _min_y && node_ys[k] <= _max_y)
+                        {
+                            _node_ids.push_back(node_ids[k]);
+                        }
+                    }
+                }
+            }
+
+            // the id of the wall nearest to the point, or `npos` if no wall is within `_max_distance`.
+            size_t findNearestWall(precision_type _x, precision_type _y, precision_type _max_distance = std::numeric_limits<precision_type>::max()) const
+            {
+                size_t nearest_id = npos;
+                precision_type best_distance = squareBound(_max_distance);
+                visitNearCells(_x, _y, best_distance, [&](size_t _cell)
+                {
+                    for (size_t k = wall_cell_offsets[_cell]; k < wall_cell_offsets[_cell + 1]; ++k)
+                    {
+                        const wall_segment& segment = walls[wall_cell_items[k]];
+                        const precision_type distance = getSquaredDistance(segment, _x, _y);
+                        if (distance < best_distance || (distance == best_distance && (nearest_id == npos || segment.id < nearest_id)))
+                        {
+                            best_distance = distance;
+                            nearest_id = segment.id;
+                        }
+                    }
+                });
+                return nearest_id;
+            }
+
+            // the id of the node nearest to the point, or `npos` if no node is within `_max_distance`.
+            size_t findNearestNode(precision_type _x, precision_type _y, precision_type _max_distance = std::numeric_limits<precision_type>::max()) const
+            {
+                size_t nearest_id = npos;
+                precision_type best_distance = squareBound(_max_distance);
+                visitNearCells(_x, _y, best_distance, [&](size_t _cell)
+                {
+                    for (size_t k = node_cell_offsets[_cell]; k < node_cell_offsets[_cell + 1]; ++k)
+                    {
+                        const precision_type dx = node_xs[k] - _x;
+                        const precision_type dy = node_ys[k] - _y;
+                        const precision_type distance = dx * dx + dy * dy;
+                        if (distance < best_distance || (distance == best_distance && (nearest_id == npos || node_ids[k] < nearest_id)))
+                        {
+                            best_distance = distance;
+                            nearest_id = node_ids[k];
+                        }
+                    }
+                });
+                return nearest_id;
+            }
+
+            // the node which coincides with the point within `_tolerance`, or `npos`.
+            size_t snapToNode(precision_type _x, precision_type _y, precision_type _tolerance) const
+            {
+                return findNearestNode(_x, _y, _tolerance);
+            }
+
+            // the exact tests of the queries, also for the linear scans.
+            static bool intersects(const wall_segment& _segment, precision_type _min_x, precision_type _min_y, precision_type _max_x, precision_type _max_y)
+            {
+                // clip the segment by the slabs of the box.
+                precision_type t0 = 0;
+                precision_type t1 = 1;
+                return clip(_segment.x1 - _segment.x0, _segment.x0, _min_x, _max_x, t0, t1)
+                    && clip(_segment.y1 - _segment.y0, _segment.y0, _min_y, _max_y, t0, t1);
+            }
+
+            static precision_type getSquaredDistance(const wall_segment& _segment, precision_type _x, precision_type _y)
+            {
+                const precision_type dx = _segment.x1 - _segment.x0;
+                const precision_type dy = _segment.y1 - _segment.y0;
+                const precision_type length = dx * dx + dy * dy;
+                precision_type t = 0;
+                if (length > 0)
+                {
+                    t = std::min<precision_type>(std::max<precision_type>(((_x - _segment.x0) * dx + (_y - _segment.y0) * dy) / length, 0), 1);
+                }
+                const precision_type ex = _segment.x0 + t * dx - _x;
+                const precision_type ey = _segment.y0 + t * dy - _y;
+                return ex * ex + ey * ey;
+            }
+
+        private:
+            static bool clip(precision_type _delta, precision_type _start, precision_type _min, precision_type _max, precision_type& _t0, precision_type& _t1)
+            {
+                if (_delta == 0)
+                {
+                    return _start >= _min && _start <= _max;
+                }
+                precision_type enter = (_min - _start) / _delta;
+                precision_type leave = (_max - _start) / _delta;
+                if (enter > leave)
+                {
+                    std::swap(enter, leave);
+                }
+                _t0 = std::max(_t0, enter);
+                _t1 = std::min(_t1, leave);
+                return _t0 <= _t1;
+            }
+
+            static precision_type squareBound(precision_type _distance)
+            {
+                if (_distance >= std::sqrt(std::numeric_limits<precision_type>::max()))
+                {
+                    return std::numeric_limits<precision_type>::max();
+                }
+                return _distance * _distance;
+            }
+
+            size_t getColumn(precision_type _x) const
+            {
+                const precision_type column = std::floor((_x - origin_x) / cell_size);
+                if (!(column > 0))
+                {
+                    return 0;
+                }
+                return column >= static_cast<precision_type>(column_count) ? column_count - 1 : static_cast<size_t>(column);
+            }
+
+            size_t getRow(precision_type _y) const
+            {
+                const precision_type row = std::floor((_y - origin_y) / cell_size);
+                if (!(row > 0))
+                {
+                    return 0;
+                }
+                return row >= static_cast<precision_type>(row_count) ? row_count - 1 : static_cast<size_t>(row);
+            }
+
+            // visit the cells by the square rings around the cell of the point, until the distance to the cells
+            // of the next ring is more than the square root of `_best_distance`, which `_visit_cell` lowers.
+            template<typename TVisitCell>
+            void visitNearCells(precision_type _x, precision_type _y, const precision_type& _best_distance, TVisitCell _visit_cell) const
+            {
+                if (empty())
+                {
+                    return;
+                }
+                const std::ptrdiff_t center_column = static_cast<std::ptrdiff_t>(getColumn(_x));
+                const std::ptrdiff_t center_row = static_cast<std::ptrdiff_t>(getRow(_y));
+                const std::ptrdiff_t columns = static_cast<std::ptrdiff_t>(column_count);
+                const std::ptrdiff_t rows = static_cast<std::ptrdiff_t>(row_count);
+                const std::ptrdiff_t max_ring = std::max(std::max(center_column, columns - 1 - center_column), std::max(center_row, rows - 1 - center_row));
+                for (std::ptrdiff_t ring = 0; ring <= max_ring; ++ring)
+                {
+                    if (ring > 0)
+                    {
+                        // the distance to the cells outside of the previous rings, the sides beyond the grid have no cells.
+                        const precision_type max_value = std::numeric_limits<precision_type>::max();
+                        const precision_type left = center_column - ring >= 0 ? _x - (origin_x + (center_column - ring + 1) * cell_size) : max_value;
+                        const precision_type right = center_column + ring < columns ? origin_x + (center_column + ring) * cell_size - _x : max_value;
+                        const precision_type top = center_row - ring >= 0 ? _y - (origin_y + (center_row - ring + 1) * cell_size) : max_value;
+                        const precision_type bottom = center_row + ring < rows ? origin_y + (center_row + ring) * cell_size - _y : max_value;
+                        const precision_type bound = std::max<precision_type>(std::min(std::min(left, right), std::min(top, bottom)), 0);
+                        if (bound > std::sqrt(_best_distance))
+                        {
+                            return;
+                        }
+                    }
+                    const std::ptrdiff_t first_column = std::max<std::ptrdiff_t>(center_column - ring, 0);
+                    const std::ptrdiff_t last_column = std::min<std::ptrdiff_t>(center_column + ring, columns - 1);
+                    for (std::ptrdiff_t row = center_row - ring; row <= center_row + ring; ++row)
+                    {
+                        if (row < 0 || row >= rows)
+                        {
+                            continue;
+                        }
+                        if (row == center_row - ring || row == center_row + ring)
+                        {
+                            for (std::ptrdiff_t column = first_column; column <= last_column; ++column)
+                            {
+                                _visit_cell(static_cast<size_t>(row * columns + column));
+                            }
+                            continue;
+                        }
+                        if (center_column - ring >= 0)
+                        {
+                            _visit_cell(static_cast<size_t>(row * columns + center_column - ring));
+                        }
+                        if (center_column + ring < columns)
+                        {
+                            _visit_cell(static_cast<size_t>(row * columns + center_column + ring));
+                        }
+                    }
+                }
+            }
+
+            void bulkLoad(const std::vector<size_t>& _ids, const std::vector<precision_type>& _xs, const std::vector<precision_type>& _ys,
+                std::vector<wall_segment>& _segments, precision_type _cell_size)
+            {
+                clear();
+                if (_ids.empty())
+                {
+                    return;
+                }
+                // every wall is between two nodes, so the nodes bound the whole house.
+                precision_type min_x = _xs[0];
+                precision_type max_x = _xs[0];
+                precision_type min_y = _ys[0];
+                precision_type max_y = _ys[0];
+                for (size_t i = 1; i < _ids.size(); ++i)
+                {
+                    min_x = std::min(min_x, _xs[i]);
+                    max_x = std::max(max_x, _xs[i]);
+                    min_y = std::min(min_y, _ys[i]);
+                    max_y = std::max(max_y, _ys[i]);
+                }
+                const precision_type width = max_x - min_x;
+                const precision_type height = max_y - min_y;
+                if (_cell_size <= 0)
+                {
+                    // about 2 items by cell.
+                    const precision_type target_count = static_cast<precision_type>(std::max<size_t>((_ids.size() + _segments.size()) / 2, 1));
+                    _cell_size = std::max(std::sqrt(width * height / target_count), std::max(width, height) / target_count);
+                    if (!(_cell_size > 0))
+                    {
+                        _cell_size = 1;
+                    }
+                }
+                origin_x = min_x;
+                origin_y = min_y;
+                cell_size = _cell_size;
+                column_count = static_cast<size_t>(width / cell_size) + 1;
+                row_count = static_cast<size_t>(height / cell_size) + 1;
+                const size_t cell_count = column_count * row_count;
+
+                // the nodes are sorted by cell with a counting sort.
+                std::vector<size_t> node_cells(_ids.size());
+                node_cell_offsets.assign(cell_count + 1, 0);
+                for (size_t i = 0; i < _ids.size(); ++i)
+                {
+                    node_cells[i] = getRow(_ys[i]) * column_count + getColumn(_xs[i]);
+                    ++node_cell_offsets[node_cells[i] + 1];
+                }
+                for (size_t cell = 0; cell < cell_count; ++cell)
+                {
+                    node_cell_offsets[cell + 1] += node_cell_offsets[cell];
+                }
+                node_ids.resize(_ids.size());
+                node_xs.resize(_ids.size());
+                node_ys.resize(_ids.size());
+                std::vector<size_t> cursors(node_cell_offsets.cbegin(), node_cell_offsets.cend() - 1);
+                for (size_t i = 0; i < _ids.size(); ++i)
+                {
+                    const size_t slot = cursors[node_cells[i]]++;
+                    node_ids[slot] = _ids[i];
+                    node_xs[slot] = _xs[i];
+                    node_ys[slot] = _ys[i];
+                }
+
+                // the walls are counted in the cells which they cross, then placed in the order of the walls,
+                // so the items of every cell are sorted.
+                walls.swap(_segments);
+                wall_cell_offsets.assign(cell_count + 1, 0);
+                for (const wall_segment& segment : walls)
+                {
+                    forEachCell(segment, [this](size_t _cell) { ++wall_cell_offsets[_cell + 1]; });
+                }
+                for (size_t cell = 0; cell < cell_count; ++cell)
+                {
+                    wall_cell_offsets[cell + 1] += wall_cell_offsets[cell];
+                }
+                wall_cell_items.resize(wall_cell_offsets.back());
+                cursors.assign(wall_cell_offsets.cbegin(), wall_cell_offsets.cend() - 1);
+                for (size_t i = 0; i < walls.size(); ++i)
+                {
+                    forEachCell(walls[i], [this, &cursors, i](size_t _cell) { wall_cell_items[cursors[_cell]++] = static_cast<uint32_t>(i); });
+                }
+            }
+
+            bool isListed(size_t _cell, uint32_t _item) const
+            {
+                return std::binary_search(wall_cell_items.cbegin() + wall_cell_offsets[_cell], wall_cell_items.cbegin() + wall_cell_offsets[_cell + 1], _item);
+            }
+
+            // walk the grid from the cell of the start to the cell of the end, stepping to the next column or row
+            // at the border which the segment crosses first. the cells make a staircase, one step by crossed border.
+            template<typename TVisitCell>
+            void forEachCell(const wall_segment& _segment, TVisitCell _visit_cell) const
+            {
+                const bool backward_x = _segment.x1 < _segment.x0;
+                const bool backward_y = _segment.y1 < _segment.y0;
+                const precision_type dx = _segment.x1 - _segment.x0;
+                const precision_type dy = _segment.y1 - _segment.y0;
+                const size_t last_column = getColumn(_segment.x1);
+                const size_t last_row = getRow(_segment.y1);
+                size_t column = getColumn(_segment.x0);
+                size_t row = getRow(_segment.y0);
+                _visit_cell(row * column_count + column);
+                while (column != last_column || row != last_row)
+                {
+                    bool step_x = row == last_row;
+                    if (column != last_column && row != last_row)
+                    {
+                        const precision_type border_x = origin_x + static_cast<precision_type>(backward_x ? column : column + 1) * cell_size;
+                        const precision_type border_y = origin_y + static_cast<precision_type>(backward_y ? row : row + 1) * cell_size;
+                        const precision_type t_x = (border_x - _segment.x0) / dx;
+                        const precision_type t_y = (border_y - _segment.y0) / dy;
+                        // through a corner, the step goes first to the cell which holds the corner itself.
+                        step_x = t_x < t_y || (t_x == t_y && !backward_x);
+                    }
+                    if (step_x)
+                    {
+                        column = backward_x ? column - 1 : column + 1;
+                    }
+                    else
+                    {
+                        row = backward_y ? row - 1 : row + 1;
+                    }
+                    _visit_cell(row * column_count + column);
+                }
+            }
+
+        private:
+            precision_type              origin_x;
+            precision_type              origin_y;
+            precision_type              cell_size;
+            size_t                      column_count;
+            size_t                      row_count;
+            // the nodes in the order of the cells, the nodes of cell `c` are `[node_cell_offsets[c], node_cell_offsets[c + 1])`.
+            std::vector<size_t>         node_ids;
+            std::vector<precision_type> node_xs;
+            std::vector<precision_type> node_ys;
+            std::vector<size_t>         node_cell_offsets;
+            // the walls in the order of the build, the cells list their indices.
+            std::vector<wall_segment>   walls;
+            std::vector<size_t>         wall_cell_offsets;
+            std::vector<uint32_t>       wall_cell_items;
+        };
+    }
+}
@@ -0,0 +1,325 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdio>
+
+#include <bimpp/svgex/validator.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        enum class load_phase
+        {
+            xml_parse,      // `xml_document::parse`
+            traversal,      // the traversal of the DOM, without the decoding of the `bimpp` attributes
+            json_decode,    // the decoding of the `bimpp` attributes and the insertion of the entities
+            validation,     // the checks of the references
+            house_copy      // the move of the storage to the house
+        };
+
+        enum class rejection_reason
+        {
+            json_syntax,    // the attribute is not valid json
+            not_object,     // the json is not an object
+            missing_key,    // the `type` or the `id` is missing or has a wrong type
+            unknown_type,   // the `type` is not a node, a wall, a hole or a room
+            invalid_node,   // `x` or `y` is missing or not a number
+            invalid_wall,   // a node id or `thickness` is missing or has a wrong type
+            invalid_hole,   // `wall-id`, `distance` or `width` is missing or has a wrong type
+            invalid_room,   // `wall-ids` is missing, or has no valid wall id
+            repeated_id     // the id is already used by an entity of the same type
+        };
+
+        inline const char* to_string(load_phase _phase)
+        {
+            switch (_phase)
+            {
+            case load_phase::xml_parse: return "xml_parse";
+            case load_phase::traversal: return "traversal";
+            case load_phase::json_decode: return "json_decode";
+            case load_phase::validation: return "validation";
+            default: return "house_copy";
+            }
+        }
+
+        inline const char* to_string(rejection_reason _reason)
+        {
+            switch (_reason)
+            {
+            case rejection_reason::json_syntax: return "json_syntax";
+            case rejection_reason::not_object: return "not_object";
+            case rejection_reason::missing_key: return "missing_key";
+            case rejection_reason::unknown_type: return "unknown_type";
+            case rejection_reason::invalid_node: return "invalid_node";
+            case rejection_reason::invalid_wall: return "invalid_wall";
+            case rejection_reason::invalid_hole: return "invalid_hole";
+            case rejection_reason::invalid_room: return "invalid_room";
+            default: return "repeated_id";
+            }
+        }
+
+        // the statistics which are not collected, every member is empty so the calls are compiled out.
+        class null_stats
+        {
+        public:
+            // the unknown attributes throw, see `diagnostics` for the lenient loading.
+            static const bool lenient = false;
+
+            class phase_scope
+            {
+            public:
+                phase_scope(null_stats& _stats, load_phase _phase)
+                {}
+            };
+
+            void setSource(const char* _svg, size_t _svg_size) {}
+            void onElement() {}
+            void onBimPP() {}
+            void onEntity(entity_type _type) {}
+            void onRejected(rejection_reason _reason, const char* _bimpp) {}
+            void onUnknownAttribute(const char* _name, size_t _name_size) {}
+            void onUnknownCssProperty(const char* _location) {}
+            void onUnknownElement(const char* _name, size_t _name_size) {}
+            void onInvalidValue(const char* _detail, size_t _detail_size, const char* _location) {}
+            void onIssue(const validation_issue& _issue) {}
+        };
+
+        // the statistics of a loading, pass it to `loader::load`.
+        // the time and the allocations of a phase do not include the phases which are nested in it.
+        class load_stats
+        {
+        public:
+            static const size_t phase_count = 5;
+            static const size_t reason_count = 9;
+            static const size_t max_rejection_count = 32;
+            static const bool lenient = false;
+
+            struct rejection
+            {
+                rejection_reason    reason;
+                size_t              offset;     // the offset of the attribute value in the svg
+            };
+
+            // measures a phase from its construction to its destruction.
+            class phase_scope
+            {
+            public:
+                phase_scope(load_stats& _stats, load_phase _phase)
+                    : stats(_stats)
+                    , phase(static_cast<size_t>(_phase))
+                    , parent(_stats.active_phase)
+                    , start_allocation_count(_stats.getAllocationCount())
+                    , start_time(std::chrono::steady_clock::now())
+                {
+                    stats.active_phase = phase;
+                }
+
+                ~phase_scope()
+                {
+                    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+                    const size_t allocation_count = stats.getAllocationCount() - start_allocation_count;
+                    stats.phase_seconds[phase] += seconds;
+                    stats.phase_allocation_counts[phase] += allocation_count;
+                    if (parent != npos)
+                    {
+                        stats.phase_seconds[parent] -= seconds;
+                        stats.phase_allocation_counts[parent] -= allocation_count;
+                    }
+                    stats.active_phase = parent;
+                }
+
+                phase_scope(const phase_scope&) = delete;
+                phase_scope& operator=(const phase_scope&) = delete;
+
+            private:
+                load_stats&                             stats;
+                size_t                                  phase;
+                size_t                                  parent;
+                size_t                                  start_allocation_count;
+                std::chrono::steady_clock::time_point   start_time;
+            };
+
+        public:
+            load_stats()
+                : allocation_counter(nullptr)
+            {
+                reset();
+            }
+
+            void reset()
+            {
+                phase_seconds.fill(0.0);
+                phase_allocation_counts.fill(0);
+                entity_counts.fill(0);
+                rejection_counts.fill(0);
+                rejections.clear();
+                svg_begin = nullptr;
+                byte_count = 0;
+                element_count = 0;
+                bimpp_count = 0;
+                active_phase = npos;
+            }
+
+            void setSource(const char* _svg, size_t _svg_size)
+            {
+                svg_begin = _svg;
+                byte_count += _svg_size;
+            }
+
+            void onElement()
+            {
+                ++element_count;
+            }
+
+            void onBimPP()
+            {
+                ++bimpp_count;
+            }
+
+            void onEntity(entity_type _type)
+            {
+                ++entity_counts[static_cast<size_t>(_type)];
+            }
+
+            void onRejected(rejection_reason _reason, const char* _bimpp)
+            {
+                ++rejection_counts[static_cast<size_t>(_reason)];
+                if (rejections.size() < max_rejection_count)
+                {
+                    rejection record;
+                    record.reason = _reason;
+                    record.offset = static_cast<size_t>(_bimpp - svg_begin);
+                    rejections.push_back(record);
+                }
+            }
+
+            // only the lenient loading reports these.
+            void onUnknownAttribute(const char* _name, size_t _name_size) {}
+            void onUnknownCssProperty(const char* _location) {}
+            void onUnknownElement(const char* _name, size_t _name_size) {}
+            void onInvalidValue(const char* _detail, size_t _detail_size, const char* _location) {}
+            void onIssue(const validation_issue& _issue) {}
+
+            double getPhaseSeconds(load_phase _phase) const
+            {
+                return phase_seconds[static_cast<size_t>(_phase)];
+            }
+
+            size_t getPhaseAllocationCount(load_phase _phase) const
+            {
+                return phase_allocation_counts[static_cast<size_t>(_phase)];
+            }
+
+            size_t getEntityCount(entity_type _type) const
+            {
+                return entity_counts[static_cast<size_t>(_type)];
+            }
+
+            size_t getRejectionCount(rejection_reason _reason) const
+            {
+                return rejection_counts[static_cast<size_t>(_reason)];
+            }
+
+            // the first `max_rejection_count` rejected attributes.
+            const std::vector<rejection>& getRejections() const
+            {
+                return rejections;
+            }
+
+            size_t getByteCount() const { return byte_count; }
+            size_t getElementCount() const { return element_count; }
+            size_t getBimPPCount() const { return bimpp_count; }
+
+            void toJson(std::string& _json) const
+            {
+                _json = "{\"bytes\":" + std::to_string(byte_count)
+                    + ",\"elements\":" + std::to_string(element_count)
+                    + ",\"bimpp\":" + std::to_string(bimpp_count)
+                    + ",\"entities\":{\"node\":" + std::to_string(entity_counts[0])
+                    + ",\"wall\":" + std::to_string(entity_counts[1])
+                    + ",\"hole\":" + std::to_string(entity_counts[2])
+                    + ",\"room\":" + std::to_string(entity_counts[3])
+                    + "},\"phases\":{";
+                for (size_t i = 0; i < phase_count; ++i)
+                {
+                    char seconds[32];
+                    std::snprintf(seconds, sizeof(seconds), "%.9f", phase_seconds[i]);
+                    _json += std::string(i > 0 ? "," : "") + "\"" + to_string(static_cast<load_phase>(i)) + "\":{\"seconds\":" + seconds;
+                    if (allocation_counter != nullptr)
+                    {
+                        _json += ",\"allocations\":" + std::to_string(phase_allocation_counts[i]);
+                    }
+                    _json += "}";
+                }
+                _json += "},\"rejected\":{";
+                bool first = true;
+                for (size_t i = 0; i < reason_count; ++i)
+                {
+                    if (rejection_counts[i] == 0)
+                    {
+                        continue;
+                    }
+                    _json += std::string(first ? "" : ",") + "\"" + to_string(static_cast<rejection_reason>(i)) + "\":" + std::to_string(rejection_counts[i]);
+                    first = false;
+                }
+                _json += "},\"rejections\":[";
+                for (size_t i = 0; i < rejections.size(); ++i)
+                {
+                    _json += std::string(i > 0 ? "," : "") + "{\"reason\":\"" + to_string(rejections[i].reason)
+                        + "\",\"offset\":" + std::to_string(rejections[i].offset) + "}";
+                }
+                _json += "]}";
+            }
+
+        public:
+            // returns the number of allocations of the process so far, e.g. from a replaced `operator new`.
+            // the allocations are not counted if it is nullptr.
+            size_t (*allocation_counter)();
+
+        private:
+            static const size_t npos = static_cast<size_t>(-1);
+
+            size_t getAllocationCount() const
+            {
+                return allocation_counter != nullptr ? allocation_counter() : 0;
+            }
+
+            std::array<double, phase_count>     phase_seconds;
+            std::array<size_t, phase_count>     phase_allocation_counts;
+            std::array<size_t, 4>               entity_counts;
+            std::array<size_t, reason_count>    rejection_counts;
+            std::vector<rejection>              rejections;
+            const char*                         svg_begin;
+            size_t                              byte_count;
+            size_t                              element_count;
+            size_t                              bimpp_count;
+            size_t                              active_phase;
+        };
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // interns the small vocabulary of the `kind` and `direction` strings into dense ids,
+        // an entity keeps 4 bytes instead of a std::string.
+        class symbol_table
+        {
+        public:
+            static const uint32_t npos = static_cast<uint32_t>(-1);
+
+            // the id of `_symbol`, it is added if it is new. the lookup of a known symbol does not allocate.
+            uint32_t intern(const std::string& _symbol)
+            {
+                std::unordered_map<std::string, uint32_t>::const_iterator itr = symbol_ids.find(_symbol);
+                if (itr != symbol_ids.cend())
+                {
+                    return itr->second;
+                }
+                const uint32_t symbol = static_cast<uint32_t>(symbols.size());
+                symbol_ids.insert(std::make_pair(_symbol, symbol));
+                symbols.push_back(_symbol);
+                return symbol;
+            }
+
+            uint32_t find(const std::string& _symbol) const
+            {
+                std::unordered_map<std::string, uint32_t>::const_iterator itr = symbol_ids.find(_symbol);
+                if (itr == symbol_ids.cend())
+                {
+                    return npos;
+                }
+                return itr->second;
+            }
+
+            const std::string& getString(uint32_t _symbol) const
+            {
+                return symbols[_symbol];
+            }
+
+            size_t size() const
+            {
+                return symbols.size();
+            }
+
+            void clear()
+            {
+                symbols.clear();
+                symbol_ids.clear();
+            }
+
+        private:
+            std::vector<std::string>                    symbols;
+            std::unordered_map<std::string, uint32_t>   symbol_ids;
+        };
+    }
+}
@@ -0,0 +1,385 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_set>
+#include <algorithm>
+#include <thread>
+#include <sstream>
+
+#include <bimpp/plan2d.hpp>
+#include <bimpp/svgex/flat_house.hpp>
+#include <bimpp/svgex/work_stealing.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        enum class entity_type
+        {
+            node,
+            wall,
+            hole,
+            room
+        };
+
+        enum class validation_error
+        {
+            invalid_wall,   // `wall::isValid` is false
+            invalid_hole,   // `hole::isValid` is false
+            empty_room,     // the room has no wall
+            missing_node,   // `target_id` is not the id of a node
+            missing_wall    // `target_id` is not the id of a wall
+        };
+
+        struct validation_issue
+        {
+            entity_type         type;
+            size_t              id;
+            validation_error    error;
+            size_t              target_id;
+        };
+
+        struct validation_report
+        {
+            bool isValid() const
+            {
+                return issues.empty();
+            }
+
+            // sorted by the entity type, the id and the error.
+            std::vector<validation_issue> issues;
+        };
+
+        inline const char* to_string(entity_type _type)
+        {
+            switch (_type)
+            {
+            case entity_type::node: return "node";
+            case entity_type::wall: return "wall";
+            case entity_type::hole: return "hole";
+            case entity_type::room: return "room";
+            }
+            return "unknown";
+        }
+
+        inline std::string to_string(const validation_issue& _issue)
+        {
+            std::ostringstream oss;
+            oss << to_string(_issue.type) << " " << _issue.id << ": ";
+            switch (_issue.error)
+            {
+            case validation_error::invalid_wall: oss << "invalid wall"; break;
+            case validation_error::invalid_hole: oss << "invalid hole"; break;
+            case validation_error::empty_room: oss << "no wall"; break;
+            case validation_error::missing_node: oss << "missing node " << _issue.target_id; break;
+            case validation_error::missing_wall: oss << "missing wall " << _issue.target_id; break;
+            }
+            return oss.str();
+        }
+
+        // a set of ids, the small dense ids are kept in a bitset and the others in a hash set.
+        class id_set
+        {
+        public:
+            template<typename TIterator, typename TGetId>
+            void build(TIterator _begin, TIterator _end, TGetId _get_id)
+            {
+                const size_t count = static_cast<size_t>(std::distance(_begin, _end));
+                const size_t dense_limit = 4 * count + 1024;
+                bits.clear();
+                sparse_ids.clear();
+                for (TIterator itr = _begin; itr != _end; ++itr)
+                {
+                    const size_t id = _get_id(*itr);
+                    if (id >= dense_limit)
+                    {
+                        sparse_ids.insert(id);
+                        continue;
+                    }
+                    if (id >= bits.size())
+                    {
+                        bits.resize(std::min(dense_limit, std::max(id + 1, 2 * bits.size())), false);
+                    }
+                    bits[id] = true;
+                }
+            }
+
+            bool contains(size_t _id) const
+            {
+                if (_id < bits.size())
+                {
+                    return bits[_id];
+                }
+                return !sparse_ids.empty() && sparse_ids.count(_id) != 0;
+            }
+
+        private:
+            std::vector<bool>           bits;
+            std::unordered_set<size_t>  sparse_ids;
+        };
+
+        // checks the references between the entities of a house and reports every broken one.
+        // the id indices are built once, then the walls, holes and rooms are checked in parallel chunks.
+        template<typename TConstant = plan2d::constant<>>
+        class validator
+        {
+        public:
+            typedef typename plan2d::node<TConstant>        node_type;
+            typedef typename std::map<size_t, node_type>    node_map;
+            typedef typename plan2d::wall<TConstant>        wall_type;
+            typedef typename std::map<size_t, wall_type>    wall_map;
+            typedef typename plan2d::hole<TConstant>        hole_type;
+            typedef typename std::map<size_t, hole_type>    hole_map;
+            typedef typename plan2d::room<TConstant>        room_type;
+            typedef typename std::map<size_t, room_type>    room_map;
+            typedef typename plan2d::house<TConstant>       house_type;
+            typedef flat_house<TConstant>                   flat_house_type;
+
+            // all the cores are used if `_thread_count` is 0, the houses of at most 4096 walls, holes and rooms
+            // are always checked on the calling thread.
+            static bool validate(const node_map& _nodes, const wall_map& _walls, const hole_map& _holes, const room_map& _rooms,
+                validation_report& _report, size_t _thread_count = 0)
+            {
+                id_set node_ids;
+                node_ids.build(_nodes.cbegin(), _nodes.cend(), getKey<node_map>);
+                id_set wall_ids;
+                wall_ids.build(_walls.cbegin(), _walls.cend(), getKey<wall_map>);
+
+                // the maps can not be split into chunks, so their entries are gathered first.
+                std::vector<const typename wall_map::value_type*> all_walls;
+                gather(_walls, all_walls);
+                std::vector<const typename hole_map::value_type*> all_holes;
+                gather(_holes, all_holes);
+                std::vector<const typename room_map::value_type*> all_rooms;
+                gather(_rooms, all_rooms);
+
+                run(all_walls.size(), all_holes.size(), all_rooms.size(), _report, _thread_count,
+                    [&](entity_type _type, size_t _begin, size_t _end, std::vector<validation_issue>& _issues)
+                    {
+                        for (size_t i = _begin; i < _end; ++i)
+                        {
+                            if (_type == entity_type::wall)
+                            {
+                                checkWall(all_walls[i]->first, all_walls[i]->second, node_ids, _issues);
+                            }
+                            else if (_type == entity_type::hole)
+                            {
+                                checkHole(all_holes[i]->first, all_holes[i]->second, wall_ids, _issues);
+                            }
+                            else
+                            {
+                                const std::vector<size_t>& room_wall_ids = all_rooms[i]->second.wall_ids;
+                                checkRoom(all_rooms[i]->first, room_wall_ids.data(), room_wall_ids.data() + room_wall_ids.size(), wall_ids, _issues);
+                            }
+                        }
+                    });
+                return _report.isValid();
+            }
+
+            static bool validate(const house_type& _house, validation_report& _report, size_t _thread_count = 0)
+            {
+                return validate(_house.nodes, _house.walls, _house.holes, _house.rooms, _report, _thread_count);
+            }
+
+            // the columns are split directly and the ids are looked up in the indices of `flat_house`.
+            static bool validate(const flat_house_type& _house, validation_report& _report, size_t _thread_count = 0)
+            {
+                run(_house.walls.ids.size(), _house.holes.ids.size(), _house.rooms.ids.size(), _report, _thread_count,
+                    [&_house](entity_type _type, size_t _begin, size_t _end, std::vector<validation_issue>& _issues)
+                    {
+                        wall_type bim_wall;
+                        hole_type bim_hole;
+                        for (size_t i = _begin; i < _end; ++i)
+                        {
+                            if (_type == entity_type::wall)
+                            {
+                                _house.getWall(i, bim_wall);
+                                checkWall(_house.walls.ids[i], bim_wall, _house.nodes.index, _issues);
+                            }
+                            else if (_type == entity_type::hole)
+                            {
+                                _house.getHole(i, bim_hole);
+                                checkHole(_house.holes.ids[i], bim_hole, _house.walls.index, _issues);
+                            }
+                            else
+                            {
+                                const size_t* room_wall_ids = _house.rooms.wall_ids.data();
+                                checkRoom(_house.rooms.ids[i],
+                                    room_wall_ids + _house.rooms.wall_id_offsets[i],
+                                    room_wall_ids + _house.rooms.wall_id_offsets[i + 1],
+                                    _house.walls.index, _issues);
+                            }
+                        }
+                    });
+                return _report.isValid();
+            }
+
+        private:
+            template<typename TMap>
+            static size_t getKey(const typename TMap::value_type& _pair)
+            {
+                return _pair.first;
+            }
+
+            template<typename TMap, typename TVector>
+            static void gather(const TMap& _map, TVector& _entries)
+            {
+                _entries.reserve(_map.size());
+                for (const typename TMap::value_type& p_entry : _map)
+                {
+                    _entries.push_back(&p_entry);
+                }
+            }
+
+            template<typename TIndex>
+            static void checkWall(size_t _id, const wall_type& _wall, const TIndex& _node_ids, std::vector<validation_issue>& _issues)
+            {
+                if (!_wall.isValid())
+                {
+                    _issues.push_back(validation_issue{ entity_type::wall, _id, validation_error::invalid_wall, _id });
+                }
+                if (!_node_ids.contains(_wall.start_node_id))
+                {
+                    _issues.push_back(validation_issue{ entity_type::wall, _id, validation_error::missing_node, _wall.start_node_id });
+                }
+                if (_wall.end_node_id != _wall.start_node_id
+                    && !_node_ids.contains(_wall.end_node_id))
+                {
+                    _issues.push_back(validation_issue{ entity_type::wall, _id, validation_error::missing_node, _wall.end_node_id });
+                }
+            }
+
+            template<typename TIndex>
+            static void checkHole(size_t _id, const hole_type& _hole, const TIndex& _wall_ids, std::vector<validation_issue>& _issues)
+            {
+                if (!_hole.isValid())
+                {
+                    _issues.push_back(validation_issue{ entity_type::hole, _id, validation_error::invalid_hole, _id });
+                }
+                if (!_wall_ids.contains(_hole.wall_id))
+                {
+                    _issues.push_back(validation_issue{ entity_type::hole, _id, validation_error::missing_wall, _hole.wall_id });
+                }
+            }
+
+            template<typename TIndex>
+            static void checkRoom(size_t _id, const size_t* _room_wall_begin, const size_t* _room_wall_end, const TIndex& _wall_ids, std::vector<validation_issue>& _issues)
+            {
+                if (_room_wall_begin == _room_wall_end)
+                {
+                    _issues.push_back(validation_issue{ entity_type::room, _id, validation_error::empty_room, _id });
+                }
+                for (const size_t* wall_id = _room_wall_begin; wall_id != _room_wall_end; ++wall_id)
+                {
+                    if (!_wall_ids.contains(*wall_id))
+                    {
+                        _issues.push_back(validation_issue{ entity_type::room, _id, validation_error::missing_wall, *wall_id });
+                    }
+                }
+            }
+
+            // `_check(type, begin, end, issues)` checks the entities `[begin, end)` of one type.
+            template<typename TCheck>
+            static void run(size_t _wall_count, size_t _hole_count, size_t _room_count,
+                validation_report& _report, size_t _thread_count, const TCheck& _check)
+            {
+                struct chunk
+                {
+                    entity_type type;
+                    size_t      begin;
+                    size_t      end;
+                };
+                const size_t chunk_size = 4096;
+                std::vector<chunk> chunks;
+                const std::pair<entity_type, size_t> counts[] = {
+                    std::make_pair(entity_type::wall, _wall_count),
+                    std::make_pair(entity_type::hole, _hole_count),
+                    std::make_pair(entity_type::room, _room_count)
+                };
+                for (const std::pair<entity_type, size_t>& count : counts)
+                {
+                    for (size_t begin = 0; begin < count.second; begin += chunk_size)
+                    {
+                        chunks.push_back(chunk{ count.first, begin, std::min(begin + chunk_size, count.second) });
+                    }
+                }
+
+                if (_thread_count == 0)
+                {
+                    _thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+                }
+                _thread_count = std::max<size_t>(std::min(_thread_count, chunks.size()), 1);
+
+                _report.issues.clear();
+                // a house of at most a chunk of entities is checked on the calling thread, a thread would cost more.
+                if (_thread_count == 1
+                    || _wall_count + _hole_count + _room_count <= chunk_size)
+                {
+                    for (const chunk& task : chunks)
+                    {
+                        _check(task.type, task.begin, task.end, _report.issues);
+                    }
+                }
+                else
+                {
+                    std::vector<std::vector<validation_issue>> worker_issues(_thread_count);
+                    work_stealing_scheduler scheduler(chunks.size(), _thread_count);
+                    auto run_worker = [&chunks, &worker_issues, &scheduler, &_check](size_t _worker)
+                    {
+                        size_t task = 0;
+                        while (scheduler.next(_worker, task))
+                        {
+                            _check(chunks[task].type, chunks[task].begin, chunks[task].end, worker_issues[_worker]);
+                        }
+                    };
+                    runWorkers(_thread_count, run_worker);
+
+                    for (const std::vector<validation_issue>& issues : worker_issues)
+                    {
+                        _report.issues.insert(_report.issues.end(), issues.cbegin(), issues.cend());
+                    }
+                }
+                std::sort(_report.issues.begin(), _report.issues.end(), [](const validation_issue& _a, const validation_issue& _b)
+                {
+                    if (_a.type != _b.type)
+                    {
+                        return _a.type < _b.type;
+                    }
+                    if (_a.id != _b.id)
+                    {
+                        return _a.id < _b.id;
+                    }
+                    if (_a.error != _b.error)
+                    {
+                        return _a.error < _b.error;
+                    }
+                    return _a.target_id < _b.target_id;
+                });
+            }
+        };
+    }
+}
@@ -0,0 +1,179 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <algorithm>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // hands out the tasks `[0, task_count)` to the workers.
+        // every worker starts with a contiguous range of tasks and takes them from the front,
+        // a worker whose range is empty steals the back half of the range of another worker.
+        class work_stealing_scheduler
+        {
+        public:
+            work_stealing_scheduler(size_t _task_count, size_t _worker_count)
+                : ranges(std::max<size_t>(_worker_count, 1))
+            {
+                const size_t worker_count = ranges.size();
+                for (size_t i = 0; i < worker_count; ++i)
+                {
+                    ranges[i].begin = _task_count * i / worker_count;
+                    ranges[i].end = _task_count * (i + 1) / worker_count;
+                }
+            }
+
+            size_t workerCount() const
+            {
+                return ranges.size();
+            }
+
+            // return false if there is no task left.
+            bool next(size_t _worker, size_t& _task)
+            {
+                task_range& own_range = ranges[_worker];
+                if (own_range.popFront(_task))
+                {
+                    return true;
+                }
+                for (size_t i = 1; i < ranges.size(); ++i)
+                {
+                    size_t stolen_begin = 0;
+                    size_t stolen_end = 0;
+                    if (!ranges[(_worker + i) % ranges.size()].stealBack(stolen_begin, stolen_end))
+                    {
+                        continue;
+                    }
+                    _task = stolen_begin;
+                    own_range.assign(stolen_begin + 1, stolen_end);
+                    return true;
+                }
+                return false;
+            }
+
+        private:
+            struct task_range
+            {
+                task_range()
+                    : begin(0)
+                    , end(0)
+                {}
+
+                bool popFront(size_t& _task)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (begin == end)
+                    {
+                        return false;
+                    }
+                    _task = begin++;
+                    return true;
+                }
+
+                bool stealBack(size_t& _begin, size_t& _end)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (begin == end)
+                    {
+                        return false;
+                    }
+                    const size_t stolen_count = (end - begin + 1) / 2;
+                    _begin = end - stolen_count;
+                    _end = end;
+                    end = _begin;
+                    return true;
+                }
+
+                void assign(size_t _begin, size_t _end)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    begin = _begin;
+                    end = _end;
+                }
+
+                std::mutex  mutex;
+                size_t      begin;
+                size_t      end;
+            };
+
+            std::vector<task_range> ranges;
+        };
+
+        // run `_worker(0)` on the calling thread and `_worker(i)` on a thread of its own for every other worker.
+        // the started threads are always joined, even if a thread can not be started or a worker throws, and the first
+        // exception is thrown again once they are joined. the tasks of a worker which did not start are stolen by the others.
+        template<typename TWorker>
+        inline void runWorkers(size_t _worker_count, const TWorker& _worker)
+        {
+            std::mutex exception_mutex;
+            std::exception_ptr first_exception;
+            auto keepException = [&exception_mutex, &first_exception]()
+            {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if (!first_exception)
+                {
+                    first_exception = std::current_exception();
+                }
+            };
+            auto run_worker = [&_worker, &keepException](size_t _index)
+            {
+                try
+                {
+                    _worker(_index);
+                }
+                catch (...)
+                {
+                    keepException();
+                }
+            };
+            std::vector<std::thread> threads;
+            try
+            {
+                threads.reserve(_worker_count > 0 ? _worker_count - 1 : 0);
+                for (size_t i = 1; i < _worker_count; ++i)
+                {
+                    threads.emplace_back(run_worker, i);
+                }
+            }
+            catch (...)
+            {
+                keepException();
+            }
+            run_worker(0);
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+            if (first_exception)
+            {
+                std::rethrow_exception(first_exception);
+            }
+        }
+    }
+}
@@ -0,0 +1,581 @@
+/*
+ * The MIT License (MIT)
+ * Copyright © 2020 BIM++
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+
+#if defined(WIN32)
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <bimpp/plan2d.hpp>
+#include <bimpp/svgex/outline.hpp>
+
+namespace bimpp
+{
+    namespace svgex
+    {
+        // the text is formatted into a preallocated buffer, which is flushed to a file descriptor or appended to a string
+        // when it is full, so the writing has no per-element stream overhead.
+        class buffered_writer
+        {
+        public:
+            explicit buffered_writer(int _fd, size_t _capacity = 64 * 1024)
+                : fd(_fd)
+                , output(nullptr)
+                , buffer(_capacity > 64 ? _capacity : 64)
+                , position(0)
+                , failed(false)
+            {}
+
+            explicit buffered_writer(std::string& _output, size_t _capacity = 64 * 1024)
+                : fd(-1)
+                , output(&_output)
+                , buffer(_capacity > 64 ? _capacity : 64)
+                , position(0)
+                , failed(false)
+            {}
+
+            ~buffered_writer()
+            {
+                flush();
+            }
+
+            buffered_writer(const buffered_writer&) = delete;
+            buffered_writer& operator=(const buffered_writer&) = delete;
+
+            void write(const char* _data, size_t _size)
+            {
+                if (_size > buffer.size() - position)
+                {
+                    flush();
+                    if (_size > buffer.size())
+                    {
+                        writeOut(_data, _size);
+                        return;
+                    }
+                }
+                std::memcpy(&buffer[position], _data, _size);
+                position += _size;
+            }
+
+            void write(const char* _text)
+            {
+                write(_text, std::strlen(_text));
+            }
+
+            void write(const std::string& _text)
+            {
+                write(_text.data(), _text.size());
+            }
+
+            void writeChar(char _c)
+            {
+                if (position == buffer.size())
+                {
+                    flush();
+                }
+                buffer[position++] = _c;
+            }
+
+            void writeUnsigned(uint64_t _value)
+            {
+                char digits[20];
+                size_t digit_count = 0;
+                do
+                {
+                    digits[sizeof(digits) - ++digit_count] = static_cast<char>('0' + _value % 10);
+                    _value /= 10;
+                } while (_value != 0);
+                write(digits + sizeof(digits) - digit_count, digit_count);
+            }
+
+            // the shortest text with at most 6 decimals which reads back to `_value` exactly,
+            // the other values fall back to 17 significant digits.
+            // json has no text for nan and the infinities, they are written as 0 and the writer fails.
+            void writeNumber(double _value)
+            {
+                if (!std::isfinite(_value))
+                {
+                    writeChar('0');
+                    failed = true;
+                    return;
+                }
+                const double scale = 1e6;
+                const double scaled = std::round(_value * scale);
+                if (std::fabs(scaled) < 9007199254740992.0
+                    && scaled / scale == _value)
+                {
+                    if (scaled < 0)
+                    {
+                        writeChar('-');
+                    }
+                    const uint64_t magnitude = static_cast<uint64_t>(std::fabs(scaled));
+                    writeUnsigned(magnitude / 1000000);
+                    uint64_t fraction = magnitude % 1000000;
+                    if (fraction != 0)
+                    {
+                        char decimals[7] = { '.' };
+                        size_t decimal_count = 6;
+                        while (fraction % 10 == 0)
+                        {
+                            fraction /= 10;
+                            --decimal_count;
+                        }
+                        for (size_t i = decimal_count; i > 0; --i)
+                        {
+                            decimals[i] = static_cast<char>('0' + fraction % 10);
+                            fraction /= 10;
+                        }
+                        write(decimals, decimal_count + 1);
+                    }
+                    return;
+                }
+                char text[32];
+                const int text_size = std::snprintf(text, sizeof(text), "%.17g", _value);
+                write(text, static_cast<size_t>(text_size));
+            }
+
+            bool flush()
+            {
+                if (position > 0)
+                {
+                    writeOut(buffer.data(), position);
+                    position = 0;
+                }
+                return !failed;
+            }
+
+            bool good() const
+            {
+                return !failed;
+            }
+
+        private:
+            void writeOut(const char* _data, size_t _size)
+            {
+                if (output != nullptr)
+                {
+                    output->append(_data, _size);
+                    return;
+                }
+                while (_size > 0 && !failed)
+                {
+#if defined(WIN32)
+                    const int written = ::_write(fd, _data, static_cast<unsigned int>(_size));
+#else
+                    const ssize_t written = ::write(fd, _data, _size);
+#endif
+                    if (written <= 0)
+                    {
+                        failed = true;
+                        return;
+                    }
+                    _data += written;
+                    _size -= static_cast<size_t>(written);
+                }
+            }
+
+        private:
+            int                 fd;
+            std::string*        output;
+            std::vector<char>   buffer;
+            size_t              position;
+            bool                failed;
+        };
+
+        // writes a house in the markup of the samples, which `loader::load` reads back:
+        // the rooms as paths, the walls and the holes as lines and the nodes as circles, each with its `bimpp` attribute.
+        template<typename TConstant = plan2d::constant<>>
+        class svg_writer
+        {
+        public:
+            typedef typename TConstant::precision_type      precision_type;
+            typedef typename plan2d::node<TConstant>        node_type;
+            typedef typename plan2d::wall<TConstant>        wall_type;
+            typedef typename plan2d::hole<TConstant>        hole_type;
+            typedef typename plan2d::room<TConstant>        room_type;
+            typedef typename plan2d::house<TConstant>       house_type;
+            typedef room_outlines<TConstant>                room_outlines_type;
+
+        public:
+            // the outline of a room is taken from `_outlines` if it has the room,
+            // otherwise the path is made of the walls of the room chained into rings.
+            static bool write(const house_type& _house, buffered_writer& _writer, const room_outlines_type* _outlines = nullptr)
+            {
+                precision_type width = 0;
+                precision_type height = 0;
+                for (std::pair<const size_t, node_type> const& node_pair : _house.nodes)
+                {
+                    width = std::max(width, node_pair.second.x);
+                    height = std::max(height, node_pair.second.y);
+                }
+                _writer.write("<?xml version=\"1.0\" standalone=\"no\" ?>\n<svg width=\"");
+                _writer.writeNumber(std::ceil(width));
+                _writer.write("px\" height=\"");
+                _writer.writeNumber(std::ceil(height));
+                _writer.write("px\" xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" >\n");
+
+                for (std::pair<const size_t, room_type> const& room_pair : _house.rooms)
+                {
+                    writeRoom(_house, room_pair.first, room_pair.second, _writer, _outlines);
+                }
+                for (std::pair<const size_t, wall_type> const& wall_pair : _house.walls)
+                {
+                    writeWall(_house, wall_pair.first, wall_pair.second, _writer);
+                }
+                for (std::pair<const size_t, hole_type> const& hole_pair : _house.holes)
+                {
+                    writeHole(_house, hole_pair.first, hole_pair.second, _writer);
+                }
+                for (std::pair<const size_t, node_type> const& node_pair : _house.nodes)
+                {
+                    writeNode(node_pair.first, node_pair.second, _writer);
+                }
+                _writer.write("</svg>\n");
+                return _writer.flush();
+            }
+
+            static bool write(const house_type& _house, std::string& _svg, const room_outlines_type* _outlines = nullptr)
+            {
+                _svg.clear();
+                buffered_writer writer(_svg);
+                return write(_house, writer, _outlines);
+            }
+
+            static bool write(const house_type& _house, const std::string& _path, const room_outlines_type* _outlines = nullptr)
+            {
+#if defined(WIN32)
+                const int fd = ::_open(_path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+                const int fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+                if (fd < 0)
+                {
+                    return false;
+                }
+                bool success = false;
+                {
+                    buffered_writer writer(fd);
+                    success = write(_house, writer, _outlines);
+                }
+#if defined(WIN32)
+                return ::_close(fd) == 0 && success;
+#else
+                return ::close(fd) == 0 && success;
+#endif
+            }
+
+        private:
+            static void writePoint(precision_type _x, precision_type _y, buffered_writer& _writer)
+            {
+                _writer.writeNumber(_x);
+                _writer.writeChar(',');
+                _writer.writeNumber(_y);
+            }
+
+            static void writeAttribute(const char* _name, precision_type _value, buffered_writer& _writer)
+            {
+                _writer.writeChar(' ');
+                _writer.write(_name);
+                _writer.write("=\"");
+                _writer.writeNumber(_value);
+                _writer.writeChar('"');
+            }
+
+            // a json string inside the `bimpp` attribute. the loader turns every `'` of the attribute into `"`,
+            // so the quotes of the value are written as unicode escapes, and the markup characters as entities.
+            static void writeString(const std::string& _value, buffered_writer& _writer)
+            {
+                static const char hex_digits[] = "0123456789abcdef";
+                _writer.writeChar('\'');
+                for (char c : _value)
+                {
+                    const unsigned char u = static_cast<unsigned char>(c);
+                    if (c == '\'' || c == '"' || c == '\\' || u < 0x20)
+                    {
+                        const char escaped[] = { '\\', 'u', '0', '0', hex_digits[u >> 4], hex_digits[u & 0xf] };
+                        _writer.write(escaped, sizeof(escaped));
+                    }
+                    else if (c == '&')
+                    {
+                        _writer.write("&amp;");
+                    }
+                    else if (c == '<')
+                    {
+                        _writer.write("&lt;");
+                    }
+                    else if (c == '>')
+                    {
+                        _writer.write("&gt;");
+                    }
+                    else
+                    {
+                        _writer.writeChar(c);
+                    }
+                }
+                _writer.writeChar('\'');
+            }
+
+            static void writeRoom(const house_type& _house, size_t _id, const room_type& _room, buffered_writer& _writer, const room_outlines_type* _outlines)
+            {
+                _writer.write("\t<path");
+                size_t slot = id_index::npos;
+                if (_outlines != nullptr)
+                {
+                    slot = _outlines->find(_id);
+                }
+                if (slot != id_index::npos
+                    && _outlines->getRingCount(slot) > 0)
+                {
+                    _writer.write(" d=\"");
+                    for (size_t ring = 0; ring < _outlines->getRingCount(slot); ++ring)
+                    {
+                        const std::pair<const typename room_outlines_type::point*, const typename room_outlines_type::point*> points = _outlines->getRing(slot, ring);
+                        _writer.writeChar('M');
+                        for (const typename room_outlines_type::point* point = points.first; point != points.second; ++point)
+                        {
+                            writePoint(point->x, point->y, _writer);
+                            _writer.writeChar(' ');
+                        }
+                        _writer.write("z ");
+                    }
+                    _writer.writeChar('"');
+                }
+                else
+                {
+                    writeWallRings(_house, _room, _writer);
+                }
+                _writer.write(" fill-rule=\"evenodd\" fill=\"rgb(192,192,192)\" bimpp=\"{'type':'room','id':");
+                _writer.writeUnsigned(_id);
+                _writer.write(",'wall-ids':[");
+                for (size_t i = 0; i < _room.wall_ids.size(); ++i)
+                {
+                    if (i > 0)
+                    {
+                        _writer.writeChar(',');
+                    }
+                    _writer.writeUnsigned(_room.wall_ids[i]);
+                }
+                _writer.write("],'kind':");
+                writeString(_room.kind, _writer);
+                _writer.write("}\" />\n");
+            }
+
+            // the `d` of the walls of a room, chained through their shared nodes as rings. a ring starts at the first wall
+            // which is not written yet and follows the unwritten walls from its last node, it is closed when it comes back
+            // to its first node, otherwise it is also followed from its first node. there is no `d` if no wall of the room
+            // has its nodes, it would be an empty path.
+            static void writeWallRings(const house_type& _house, const room_type& _room, buffered_writer& _writer)
+            {
+                std::vector<std::pair<size_t, size_t>> wall_node_ids;
+                wall_node_ids.reserve(_room.wall_ids.size());
+                for (size_t wall_id : _room.wall_ids)
+                {
+                    const node_type* start_node = nullptr;
+                    const node_type* end_node = nullptr;
+                    if (findWallNodes(_house, wall_id, start_node, end_node))
+                    {
+                        const wall_type& bim_wall = _house.walls.at(wall_id);
+                        wall_node_ids.push_back(std::make_pair(bim_wall.start_node_id, bim_wall.end_node_id));
+                    }
+                }
+                if (wall_node_ids.empty())
+                {
+                    return;
+                }
+                _writer.write(" d=\"");
+                std::vector<bool> written(wall_node_ids.size(), false);
+                std::vector<size_t> ring_node_ids;
+                std::vector<size_t> head_node_ids;
+                for (size_t first = 0; first < wall_node_ids.size(); ++first)
+                {
+                    if (written[first])
+                    {
+                        continue;
+                    }
+                    written[first] = true;
+                    ring_node_ids.assign(1, wall_node_ids[first].first);
+                    head_node_ids.clear();
+                    const bool closed = followWalls(wall_node_ids, first, wall_node_ids[first].second, wall_node_ids[first].first, written, ring_node_ids);
+                    if (!closed)
+                    {
+                        followWalls(wall_node_ids, first, wall_node_ids[first].first, id_index::npos, written, head_node_ids);
+                    }
+                    _writer.writeChar('M');
+                    for (size_t i = head_node_ids.size(); i > 0; --i)
+                    {
+                        writeNodePoint(_house, head_node_ids[i - 1], _writer);
+                    }
+                    for (size_t node_id : ring_node_ids)
+                    {
+                        writeNodePoint(_house, node_id, _writer);
+                    }
+                    if (closed)
+                    {
+                        _writer.write("z ");
+                    }
+                }
+                _writer.writeChar('"');
+            }
+
+            // append `_node_id` and the nodes of the unwritten walls which continue from it to `_node_ids`,
+            // it stops before `_stop_node_id` and returns true if it comes to it.
+            static bool followWalls(const std::vector<std::pair<size_t, size_t>>& _wall_node_ids, size_t _first, size_t _node_id, size_t _stop_node_id,
+                std::vector<bool>& _written, std::vector<size_t>& _node_ids)
+            {
+                while (_node_id != _stop_node_id)
+                {
+                    _node_ids.push_back(_node_id);
+                    size_t next = _first + 1;
+                    while (next < _wall_node_ids.size()
+                        && (_written[next] || (_wall_node_ids[next].first != _node_id && _wall_node_ids[next].second != _node_id)))
+                    {
+                        ++next;
+                    }
+                    if (next == _wall_node_ids.size())
+                    {
+                        return false;
+                    }
+                    _written[next] = true;
+                    _node_id = _wall_node_ids[next].first == _node_id ? _wall_node_ids[next].second : _wall_node_ids[next].first;
+                }
+                return true;
+            }
+
+            static void writeNodePoint(const house_type& _house, size_t _node_id, buffered_writer& _writer)
+            {
+                const node_type& bim_node = _house.nodes.at(_node_id);
+                writePoint(bim_node.x, bim_node.y, _writer);
+                _writer.writeChar(' ');
+            }
+
+            static void writeWall(const house_type& _house, size_t _id, const wall_type& _wall, buffered_writer& _writer)
+            {
+                _writer.write("\t<line");
+                const node_type* start_node = nullptr;
+                const node_type* end_node = nullptr;
+                if (findWallNodes(_house, _id, start_node, end_node))
+                {
+                    writeAttribute("x1", start_node->x, _writer);
+                    writeAttribute("y1", start_node->y, _writer);
+                    writeAttribute("x2", end_node->x, _writer);
+                    writeAttribute("y2", end_node->y, _writer);
+                }
+                writeAttribute("stroke-width", _wall.thickness, _writer);
+                _writer.write(" stroke=\"rgb(0,0,0)\" bimpp=\"{'type':'wall','id':");
+                _writer.writeUnsigned(_id);
+                _writer.write(",'start-node-id':");
+                _writer.writeUnsigned(_wall.start_node_id);
+                _writer.write(",'end-node-id':");
+                _writer.writeUnsigned(_wall.end_node_id);
+                _writer.write(",'thickness':");
+                _writer.writeNumber(_wall.thickness);
+                if (!_wall.kind.empty())
+                {
+                    _writer.write(",'kind':");
+                    writeString(_wall.kind, _writer);
+                }
+                _writer.write("}\" />\n");
+            }
+
+            static void writeHole(const house_type& _house, size_t _id, const hole_type& _hole, buffered_writer& _writer)
+            {
+                _writer.write("\t<line");
+                const node_type* start_node = nullptr;
+                const node_type* end_node = nullptr;
+                if (findWallNodes(_house, _hole.wall_id, start_node, end_node))
+                {
+                    // the hole is drawn on its wall, from `distance` to `distance + width` after the start node.
+                    const precision_type dx = end_node->x - start_node->x;
+                    const precision_type dy = end_node->y - start_node->y;
+                    const precision_type length = std::sqrt(dx * dx + dy * dy);
+                    const precision_type ux = length > 0 ? dx / length : 0;
+                    const precision_type uy = length > 0 ? dy / length : 0;
+                    writeAttribute("x1", start_node->x + ux * _hole.distance, _writer);
+                    writeAttribute("y1", start_node->y + uy * _hole.distance, _writer);
+                    writeAttribute("x2", start_node->x + ux * (_hole.distance + _hole.width), _writer);
+                    writeAttribute("y2", start_node->y + uy * (_hole.distance + _hole.width), _writer);
+                    writeAttribute("stroke-width", _house.walls.at(_hole.wall_id).thickness, _writer);
+                }
+                _writer.write(" stroke=\"rgb(0,128,0)\" bimpp=\"{'type':'hole','id':");
+                _writer.writeUnsigned(_id);
+                _writer.write(",'kind':");
+                writeString(_hole.kind, _writer);
+                _writer.write(",'direction':");
+                writeString(_hole.direction, _writer);
+                _writer.write(",'wall-id':");
+                _writer.writeUnsigned(_hole.wall_id);
+                _writer.write(",'width':");
+                _writer.writeNumber(_hole.width);
+                _writer.write(",'distance':");
+                _writer.writeNumber(_hole.distance);
+                _writer.write("}\" />\n");
+            }
+
+            static void writeNode(size_t _id, const node_type& _node, buffered_writer& _writer)
+            {
+                _writer.write("\t<circle");
+                writeAttribute("cx", _node.x, _writer);
+                writeAttribute("cy", _node.y, _writer);
+                _writer.write(" r=\"0.5\" fill=\"rgb(255,0,0)\" stroke-width=\"2\" stroke=\"rgb(255,0,0)\" bimpp=\"{'type':'node','id':");
+                _writer.writeUnsigned(_id);
+                _writer.write(",'x':");
+                _writer.writeNumber(_node.x);
+                _writer.write(",'y':");
+                _writer.writeNumber(_node.y);
+                _writer.write("}\" />\n");
+            }
+
+            static bool findWallNodes(const house_type& _house, size_t _wall_id, const node_type*& _start_node, const node_type*& _end_node)
+            {
+                const auto wall_itr = _house.walls.find(_wall_id);
+                if (wall_itr == _house.walls.end())
+                {
+                    return false;
+                }
+                const auto start_itr = _house.nodes.find(wall_itr->second.start_node_id);
+                const auto end_itr = _house.nodes.find(wall_itr->second.end_node_id);
+                if (start_itr == _house.nodes.end()
+                    || end_itr == _house.nodes.end())
+                {
+                    return false;
+                }
+                _start_node = &start_itr->second;
+                _end_node = &end_itr->second;
+                return true;
+            }
+        };
+    }
+}
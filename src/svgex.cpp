@@ -23,44 +23,1028 @@
 #include <bimpp/svgex.hpp>
 
 #include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <chrono>
 
 #if defined(WIN32) && !defined(NDEBUG)
 #include <crtdbg.h>
 #endif
 
-int main(int argc, char* argv[])
-{
-#if defined(WIN32) && !defined(NDEBUG)
-    _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#if !defined(WIN32)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <signal.h>
 #endif
 
-    if (argc != 2)
+namespace
+{
+    // the executable only needs the entities, so it skips the geometry and the unknown svg attributes.
+    typedef bimpp::svgex::loader<bimpp::plan2d::constant<>, bimpp::svgex::profile::metadata> loader_type;
+
+    // the allocations of the executable are only counted while `--stats` loads, the other modes only test the flag.
+    std::atomic<bool> allocation_counting(false);
+    std::atomic<size_t> allocation_count(0);
+
+    size_t countAllocations()
     {
-        return 1;
+        return allocation_count.load(std::memory_order_relaxed);
     }
 
-    // load the svg file
-    std::ifstream ifs(argv[1], std::ifstream::in);
-    if (!ifs.good())
+    std::string escapeJson(const std::string& _text)
     {
-        return 1;
+        std::string escaped;
+        for (char c : _text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char unicode[8];
+                std::snprintf(unicode, sizeof(unicode), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+                escaped += unicode;
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+        return escaped;
     }
 
-    std::string svg_context((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    // `_source` is a directory of svg files or a text file with one svg path per line.
+    bool collectPaths(const std::string& _source, std::vector<std::string>& _paths)
+    {
+        std::error_code error_code;
+        if (std::filesystem::is_directory(_source, error_code))
+        {
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(_source, error_code))
+            {
+                if (entry.is_regular_file(error_code)
+                    && entry.path().extension() == ".svg")
+                {
+                    _paths.push_back(entry.path().string());
+                }
+            }
+            std::sort(_paths.begin(), _paths.end());
+            return !error_code;
+        }
+
+        std::ifstream ifs(_source, std::ifstream::in);
+        if (!ifs.good())
+        {
+            return false;
+        }
+        std::string line;
+        while (std::getline(ifs, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if (!line.empty())
+            {
+                _paths.push_back(line);
+            }
+        }
+        return true;
+    }
 
-    // parse the svg to the bim data
-    bimpp::svgex::loader<>::house_type bim_house;
-    std::string error_message;
-    if (!bimpp::svgex::loader<>::load(svg_context, bim_house, error_message, true))
+    // get the sorted nodes
+    int computeRooms(const loader_type::house_type& _house)
     {
+        bimpp::plan2d::algorithm<>::room_ex_vector bim_room_exs;
+        if (!bimpp::plan2d::algorithm<>::computeRoomExs(_house, bim_room_exs))
+        {
+            return 1;
+        }
+        return 0;
+    }
+
+    int loadOne(const char* _path)
+    {
+        // map the svg file, it is parsed in place without copying it to the heap
+        bimpp::svgex::mapped_file svg_file;
+        if (!svg_file.open(_path))
+        {
+            return 1;
+        }
+
+        // parse the svg to the bim data
+        loader_type::house_type bim_house;
+        std::string error_message;
+        if (!loader_type::load(svg_file.data(), svg_file.size(), bim_house, error_message, true))
+        {
+            return 1;
+        }
+        return computeRooms(bim_house);
+    }
+
+    // reuse the cache of the svg in `_cache_directory` if its hash matches, otherwise load the svg and write the cache.
+    int loadCached(const char* _path, const std::string& _cache_directory)
+    {
+        bimpp::svgex::mapped_file svg_file;
+        if (!svg_file.open(_path))
+        {
+            return 1;
+        }
+        // the hash is taken before the parsing rewrites the mapping.
+        const uint64_t source_hash = bimpp::svgex::hashSource(svg_file.data(), svg_file.size());
+        char cache_name[32];
+        std::snprintf(cache_name, sizeof(cache_name), "%016llx.bimpp", static_cast<unsigned long long>(source_hash));
+        const std::string cache_path = (std::filesystem::path(_cache_directory) / cache_name).string();
+
+        loader_type::house_type bim_house;
+        loader_type::house_cache_type bim_cache;
+        if (bim_cache.open(cache_path, source_hash))
+        {
+            bim_cache.toHouse(bim_house);
+            return computeRooms(bim_house);
+        }
+
+        std::string error_message;
+        if (!loader_type::load(svg_file.data(), svg_file.size(), bim_house, error_message, true))
+        {
+            std::cerr << _path << ": " << error_message << std::endl;
+            return 1;
+        }
+        std::error_code error_code;
+        std::filesystem::create_directories(_cache_directory, error_code);
+        if (!loader_type::house_cache_type::save(bim_house, source_hash, cache_path))
+        {
+            std::cerr << cache_path << ": can not write the cache" << std::endl;
+        }
+        return computeRooms(bim_house);
+    }
+
+    // load the svg with the statistics and print them as json.
+    int loadStats(const char* _path)
+    {
+        bimpp::svgex::mapped_file svg_file;
+        if (!svg_file.open(_path))
+        {
+            return 1;
+        }
+
+        bimpp::svgex::load_stats bim_stats;
+        bim_stats.allocation_counter = &countAllocations;
+        loader_type::workspace bim_workspace;
+        loader_type::house_type bim_house;
+        std::string error_message;
+        allocation_counting.store(true, std::memory_order_relaxed);
+        const bool success = loader_type::load(svg_file.data(), svg_file.size(), bim_house, error_message, true, bim_workspace, bim_stats);
+        allocation_counting.store(false, std::memory_order_relaxed);
+
+        std::string stats_json;
+        bim_stats.toJson(stats_json);
+        std::cout << "{\"file\":\"" << escapeJson(_path)
+            << "\",\"success\":" << (success ? "true" : "false")
+            << ",\"error\":\"" << escapeJson(error_message)
+            << "\",\"stats\":" << stats_json
+            << "}" << std::endl;
+        if (!success)
+        {
+            return 1;
+        }
+        return computeRooms(bim_house);
+    }
+
+    // load the svg leniently and print its diagnostics, the rooms are computed from whatever could be loaded.
+    int loadLenient(const char* _path)
+    {
+        bimpp::svgex::mapped_file svg_file;
+        if (!svg_file.open(_path))
+        {
+            return 1;
+        }
+
+        // svgpp runs over every attribute in the full profile, so the unknown ones are reported too.
+        bimpp::svgex::diagnostics bim_diagnostics;
+        bimpp::svgex::loader<>::workspace bim_workspace;
+        bimpp::svgex::loader<>::house_type bim_house;
+        std::string error_message;
+        const bool success = bimpp::svgex::loader<>::load(svg_file.data(), svg_file.size(), bim_house, error_message, true, bim_workspace, bim_diagnostics);
+        for (const bimpp::svgex::diagnostic& entry : bim_diagnostics.getEntries())
+        {
+            std::cerr << _path << ": " << bimpp::svgex::to_string(entry) << std::endl;
+        }
+        if (bim_diagnostics.isTruncated())
+        {
+            std::cerr << _path << ": " << bim_diagnostics.getCount() - bim_diagnostics.getEntries().size() << " more diagnostics" << std::endl;
+        }
+        if (!success)
+        {
+            std::cerr << _path << ": " << error_message << std::endl;
+            return 1;
+        }
+        // the rooms are not computed over dangling references.
+        if (bim_diagnostics.getIssueCount() > 0)
+        {
+            return 2;
+        }
+        const int result = computeRooms(bim_house);
+        return result != 0 ? result : (bim_diagnostics.getCount() == 0 ? 0 : 2);
+    }
+
+#if !defined(WIN32)
+    // the limits of the daemon, the bytes of the requests are bounded as they are read.
+    struct daemon_options
+    {
+        size_t      thread_count = 0;
+        uint64_t    max_request_size = uint64_t(64) << 20;
+        // the bytes of all the requests and the responses in the daemon, `8 * max_request_size` if it is 0.
+        uint64_t    max_queued_size = 0;
+        // the clients which are served at once, the others wait in the backlog of the socket.
+        size_t      max_connection_count = 128;
+        // the time a socket client has to send a request or to take a response, and to send the next request
+        // once it has no response to wait for. 0 never times out.
+        unsigned    timeout_seconds = 30;
+    };
+
+    // the bytes of the requests and of their responses in the daemon, a reader waits until there is room for a whole request.
+    // a request is reserved at once before its payload is read, so the readers never hold a part of the budget each,
+    // and its bytes are released when its response is written.
+    class daemon_budget
+    {
+    public:
+        explicit daemon_budget(uint64_t _capacity)
+            : capacity(_capacity)
+            , used(0)
+        {}
+
+        void reserve(uint64_t _bytes)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [this, _bytes]() { return used == 0 || used + _bytes <= capacity; });
+            used += _bytes;
+        }
+
+        // a response which is larger than its reservation is charged without waiting, the next readers wait longer.
+        // the worker can not wait, the budget may be held by the requests which wait for the workers.
+        void charge(uint64_t _bytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            used += _bytes;
+        }
+
+        void release(uint64_t _bytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            used -= _bytes;
+            released.notify_all();
+        }
+
+    private:
+        uint64_t                capacity;
+        uint64_t                used;
+        std::mutex              mutex;
+        std::condition_variable released;
+    };
+
+    // move `_size` bytes of a socket before `_deadline` without blocking in the transfer itself,
+    // so a client which stops, or trickles its bytes, times out as a whole.
+    bool transferBefore(int _fd, char* _data, size_t _size, bool _write, std::chrono::steady_clock::time_point _deadline)
+    {
+        while (_size > 0)
+        {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(_deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0)
+            {
+                return false;
+            }
+            pollfd poll_fd;
+            poll_fd.fd = _fd;
+            poll_fd.events = _write ? POLLOUT : POLLIN;
+            poll_fd.revents = 0;
+            const int ready = ::poll(&poll_fd, 1, static_cast<int>(std::min<int64_t>(remaining.count(), 60 * 1000)));
+            if (ready < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (ready < 0)
+            {
+                return false;
+            }
+            if (ready == 0)
+            {
+                continue;
+            }
+            const ssize_t count = _write
+                ? ::send(_fd, _data, _size, MSG_DONTWAIT | MSG_NOSIGNAL)
+                : ::recv(_fd, _data, _size, MSG_DONTWAIT);
+            if (count < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return false;
+            }
+            _data += count;
+            _size -= static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    // a client of the daemon. the workers queue the responses and never touch the socket,
+    // the writer of the connection writes them, so a client which reads slowly only stalls itself.
+    // the bytes of a connection in the daemon are bounded too, and a socket client which does not send its request
+    // or does not take its response in time is dropped, so a slow client can not hold the budget for long.
+    class daemon_connection
+    {
+    public:
+        // `_timeout` only applies to a socket, 0 never times out.
+        daemon_connection(int _input_fd, int _output_fd, bool _owns_fd, std::shared_ptr<daemon_budget> _budget, uint64_t _max_outstanding_size,
+            std::chrono::milliseconds _timeout = std::chrono::milliseconds(0))
+            : input_fd(_input_fd)
+            , output_fd(_output_fd)
+            , owns_fd(_owns_fd)
+            , budget(_budget)
+            , max_outstanding_size(_max_outstanding_size)
+            , timeout(_timeout)
+            , outstanding_size(0)
+            , pending_count(0)
+            , finished(false)
+        {}
+
+        ~daemon_connection()
+        {
+            if (owns_fd)
+            {
+                ::close(input_fd);
+            }
+        }
+
+        daemon_connection(const daemon_connection&) = delete;
+        daemon_connection& operator=(const daemon_connection&) = delete;
+
+        // the reader waits until the connection and the daemon have room for a request of `_bytes`.
+        void reserve(uint64_t _bytes)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this, _bytes]() { return outstanding_size == 0 || outstanding_size + _bytes <= max_outstanding_size; });
+                outstanding_size += _bytes;
+                ++pending_count;
+            }
+            budget->reserve(_bytes);
+        }
+
+        // the request of a reservation was not read.
+        void cancel(uint64_t _bytes)
+        {
+            release(_bytes);
+        }
+
+        // wait for the next request. a client which waits for its responses is not idle, so it does not time out.
+        bool waitRequest()
+        {
+            if (timeout.count() == 0)
+            {
+                return true;
+            }
+            for (;;)
+            {
+                pollfd poll_fd;
+                poll_fd.fd = input_fd;
+                poll_fd.events = POLLIN;
+                poll_fd.revents = 0;
+                const int ready = ::poll(&poll_fd, 1, static_cast<int>(timeout.count()));
+                if (ready > 0)
+                {
+                    return true;
+                }
+                if (ready < 0 && errno != EINTR)
+                {
+                    return false;
+                }
+                if (ready == 0)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (pending_count == 0)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        // read a part of a request before `_deadline`, see `getDeadline`.
+        bool read(void* _data, size_t _size, std::chrono::steady_clock::time_point _deadline)
+        {
+            return timeout.count() == 0
+                ? bimpp::svgex::read_fully(input_fd, _data, _size)
+                : transferBefore(input_fd, static_cast<char*>(_data), _size, false, _deadline);
+        }
+
+        // the deadline of a transfer which starts now.
+        std::chrono::steady_clock::time_point getDeadline() const
+        {
+            return std::chrono::steady_clock::now() + timeout;
+        }
+
+        // queue the response of a request whose reservation is `_reserved`.
+        void respond(std::string&& _frame, uint64_t _reserved)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (_frame.size() > _reserved)
+            {
+                const uint64_t extra = _frame.size() - _reserved;
+                budget->charge(extra);
+                outstanding_size += extra;
+                _reserved = _frame.size();
+            }
+            responses.push_back(std::make_pair(std::move(_frame), _reserved));
+            changed.notify_all();
+        }
+
+        // answer a frame which is not a request, without a reservation.
+        void reject(std::string&& _frame)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++pending_count;
+            }
+            respond(std::move(_frame), 0);
+        }
+
+        // no more request will be read, the writer ends after the last response.
+        void finish()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            changed.notify_all();
+        }
+
+        // the loop of the writer thread of the connection.
+        void writeResponses()
+        {
+            bool broken = false;
+            for (;;)
+            {
+                std::pair<std::string, uint64_t> response;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [this]() { return !responses.empty() || (finished && pending_count == 0); });
+                    if (responses.empty())
+                    {
+                        return;
+                    }
+                    response = std::move(responses.front());
+                    responses.pop_front();
+                }
+                // the client may be gone or too slow, its remaining responses are dropped.
+                if (!broken)
+                {
+                    broken = timeout.count() == 0
+                        ? !bimpp::svgex::write_fully(output_fd, response.first.data(), response.first.size())
+                        : !transferBefore(output_fd, &response.first[0], response.first.size(), true, getDeadline());
+                    if (broken
+                        && owns_fd)
+                    {
+                        // the reader stops too.
+                        ::shutdown(input_fd, SHUT_RDWR);
+                    }
+                }
+                response.first.clear();
+                response.first.shrink_to_fit();
+                release(response.second);
+            }
+        }
+
+        const int   input_fd;
+        const int   output_fd;
+
+    private:
+        void release(uint64_t _bytes)
+        {
+            budget->release(_bytes);
+            std::lock_guard<std::mutex> lock(mutex);
+            outstanding_size -= _bytes;
+            --pending_count;
+            changed.notify_all();
+        }
+
+    private:
+        bool                                            owns_fd;
+        std::shared_ptr<daemon_budget>                  budget;
+        uint64_t                                        max_outstanding_size;
+        std::chrono::milliseconds                       timeout;
+        uint64_t                                        outstanding_size;
+        size_t                                          pending_count;
+        bool                                            finished;
+        std::deque<std::pair<std::string, uint64_t>>    responses;
+        std::mutex                                      mutex;
+        std::condition_variable                         changed;
+    };
+
+    // the connections which are served at once, the accepting waits for a free one.
+    class daemon_slots
+    {
+    public:
+        explicit daemon_slots(size_t _capacity)
+            : capacity(_capacity)
+            , used(0)
+        {}
+
+        void acquire()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [this]() { return used < capacity; });
+            ++used;
+        }
+
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --used;
+            released.notify_one();
+        }
+
+    private:
+        size_t                  capacity;
+        size_t                  used;
+        std::mutex              mutex;
+        std::condition_variable released;
+    };
+
+    struct daemon_job
+    {
+        std::shared_ptr<daemon_connection>  connection;
+        bimpp::svgex::frame_header          header;
+        std::string                         payload;
+        uint64_t                            reserved = 0;
+    };
+
+    // the requests of all the connections, their bytes are bounded by the `daemon_budget` of the readers.
+    class daemon_queue
+    {
+    public:
+        daemon_queue()
+            : closed(false)
+        {}
+
+        bool push(daemon_job&& _job)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed)
+            {
+                return false;
+            }
+            jobs.push_back(std::move(_job));
+            not_empty.notify_one();
+            return true;
+        }
+
+        // false once the queue is closed and empty.
+        bool pop(daemon_job& _job)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_empty.wait(lock, [this]() { return closed || !jobs.empty(); });
+            if (jobs.empty())
+            {
+                return false;
+            }
+            _job = std::move(jobs.front());
+            jobs.pop_front();
+            return true;
+        }
+
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            not_empty.notify_all();
+        }
+
+    private:
+        bool                    closed;
+        std::deque<daemon_job>  jobs;
+        std::mutex              mutex;
+        std::condition_variable not_empty;
+    };
+
+    std::string makeResponse(bimpp::svgex::response_status _status, uint64_t _request_id, const void* _body, size_t _body_size, const std::string& _data)
+    {
+        const bimpp::svgex::frame_header header = bimpp::svgex::make_frame_header(bimpp::svgex::response_magic,
+            static_cast<uint32_t>(_status), _request_id, _body_size + _data.size());
+        std::string frame;
+        frame.reserve(sizeof(header) + _body_size + _data.size());
+        frame.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        frame.append(static_cast<const char*>(_body), _body_size);
+        frame.append(_data);
+        return frame;
+    }
+
+    // every worker keeps its parser state and its buffers warm between the requests.
+    void runDaemonWorker(daemon_queue& _queue)
+    {
+        loader_type::workspace bim_workspace;
+        // the requests are already handled in parallel.
+        bim_workspace.validation_thread_count = 1;
+        loader_type::house_type bim_house;
+        bimpp::plan2d::algorithm<>::room_ex_vector bim_room_exs;
+        std::string svg_context;
+        std::string house_data;
+        std::string error_message;
+        daemon_job job;
+        while (_queue.pop(job))
+        {
+            const uint32_t flags = job.header.code;
+            bimpp::svgex::response_body body;
+            std::memset(&body, 0, sizeof(body));
+            error_message.clear();
+            bool success = false;
+            try
+            {
+                if ((flags & bimpp::svgex::request_path) != 0)
+                {
+                    success = bimpp::svgex::read_file(job.payload, svg_context);
+                    if (!success)
+                    {
+                        error_message = "can not read the file";
+                    }
+                }
+                else
+                {
+                    svg_context.swap(job.payload);
+                    success = true;
+                }
+                if (success)
+                {
+                    // the hash is taken before the parsing rewrites the svg.
+                    body.source_hash = bimpp::svgex::hashSource(svg_context.data(), svg_context.size());
+                    success = loader_type::load(svg_context, bim_house, error_message, (flags & bimpp::svgex::request_check) != 0, bim_workspace);
+                }
+                if (success && (flags & bimpp::svgex::request_rooms) != 0)
+                {
+                    bim_room_exs.clear();
+                    body.room_status = bimpp::plan2d::algorithm<>::computeRoomExs(bim_house, bim_room_exs) ? 1 : 0;
+                    body.room_ex_count = bim_room_exs.size();
+                }
+                if (success)
+                {
+                    loader_type::house_cache_type::serialize(bim_house, body.source_hash, house_data);
+                }
+            }
+            catch (std::exception const& e)
+            {
+                success = false;
+                error_message = e.what();
+            }
+
+            // the payload is released now, its reservation goes on with the response.
+            job.payload.clear();
+            job.payload.shrink_to_fit();
+            if (success)
+            {
+                job.connection->respond(makeResponse(bimpp::svgex::response_status::ok, job.header.request_id, &body, sizeof(body), house_data), job.reserved);
+            }
+            else
+            {
+                if (error_message.empty())
+                {
+                    error_message = "invalid plan";
+                }
+                job.connection->respond(makeResponse(bimpp::svgex::response_status::failed, job.header.request_id, nullptr, 0, error_message), job.reserved);
+            }
+            job.connection.reset();
+        }
+    }
+
+    // the bytes of a job besides its payload, so the requests without a payload are bounded too.
+    const uint64_t daemon_job_overhead = 1024;
+
+    // the payload grows with the bytes which have arrived, a header alone can not commit the size it claims.
+    bool readPayload(daemon_connection& _connection, uint64_t _size, std::string& _payload, std::chrono::steady_clock::time_point _deadline)
+    {
+        const size_t chunk_size = 64 * 1024;
+        _payload.clear();
+        while (_payload.size() < _size)
+        {
+            const size_t offset = _payload.size();
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(chunk_size, _size - offset));
+            _payload.resize(offset + chunk);
+            if (!_connection.read(&_payload[offset], chunk, _deadline))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // read the requests of a connection until it is closed, the workers answer them.
+    void readDaemonRequests(daemon_connection& _connection, const std::shared_ptr<daemon_connection>& _shared_connection,
+        daemon_queue& _queue, uint64_t _max_request_size)
+    {
+        for (;;)
+        {
+            daemon_job job;
+            if (!_connection.waitRequest())
+            {
+                return;
+            }
+            // the whole request has to arrive before the deadline.
+            const std::chrono::steady_clock::time_point deadline = _connection.getDeadline();
+            if (!_connection.read(&job.header, sizeof(job.header), deadline))
+            {
+                return;
+            }
+            // the payload of a frame which is not a request is not read, its size can not be trusted.
+            if (!bimpp::svgex::is_frame(job.header, bimpp::svgex::request_magic)
+                || job.header.payload_size > _max_request_size)
+            {
+                _connection.reject(makeResponse(bimpp::svgex::response_status::bad_request, job.header.request_id, nullptr, 0, "not a request, or too large"));
+                return;
+            }
+            job.reserved = job.header.payload_size + daemon_job_overhead;
+            _connection.reserve(job.reserved);
+            job.connection = _shared_connection;
+            if (!readPayload(_connection, job.header.payload_size, job.payload, deadline))
+            {
+                _connection.cancel(job.reserved);
+                return;
+            }
+            // the svg of a path is read by the worker, so it is reserved as if it were the payload.
+            struct stat file_stat;
+            if ((job.header.code & bimpp::svgex::request_path) != 0
+                && ::stat(job.payload.c_str(), &file_stat) == 0)
+            {
+                const uint64_t file_size = static_cast<uint64_t>(file_stat.st_size);
+                if (file_size > _max_request_size)
+                {
+                    _connection.respond(makeResponse(bimpp::svgex::response_status::failed, job.header.request_id, nullptr, 0, "the file is too large"), job.reserved);
+                    continue;
+                }
+                _connection.cancel(job.reserved);
+                job.reserved += file_size;
+                _connection.reserve(job.reserved);
+            }
+            if (!_queue.push(std::move(job)))
+            {
+                _connection.cancel(job.reserved);
+                return;
+            }
+        }
+    }
+
+    // serve a connection until it is closed and all its responses are written.
+    void serveConnection(std::shared_ptr<daemon_connection> _connection, std::shared_ptr<daemon_queue> _queue, uint64_t _max_request_size)
+    {
+        std::thread writer(&daemon_connection::writeResponses, _connection.get());
+        readDaemonRequests(*_connection, _connection, *_queue, _max_request_size);
+        _connection->finish();
+        writer.join();
+    }
+
+    // remove the socket of a previous daemon at `_path`, any other kind of file is kept and refused.
+    bool removeStaleSocket(const std::string& _path)
+    {
+        struct stat path_stat;
+        if (::lstat(_path.c_str(), &path_stat) != 0)
+        {
+            return errno == ENOENT;
+        }
+        if (!S_ISSOCK(path_stat.st_mode))
+        {
+            errno = EEXIST;
+            return false;
+        }
+        return ::unlink(_path.c_str()) == 0;
+    }
+
+    // serve the requests of stdin on stdout if `_socket_path` is "-", otherwise of the clients of a unix socket.
+    int serveDaemon(const std::string& _socket_path, daemon_options _options)
+    {
+        if (_options.thread_count == 0)
+        {
+            _options.thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        if (_options.max_queued_size == 0)
+        {
+            _options.max_queued_size = 8 * _options.max_request_size;
+        }
+        // a client which goes away must not kill the daemon.
+        ::signal(SIGPIPE, SIG_IGN);
+
+        std::shared_ptr<daemon_queue> queue = std::make_shared<daemon_queue>();
+        std::shared_ptr<daemon_budget> budget = std::make_shared<daemon_budget>(_options.max_queued_size);
+        std::shared_ptr<daemon_slots> slots = std::make_shared<daemon_slots>(std::max<size_t>(_options.max_connection_count, 1));
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < _options.thread_count; ++i)
+        {
+            workers.emplace_back(runDaemonWorker, std::ref(*queue));
+        }
+        auto stop = [&queue, &workers]()
+        {
+            queue->close();
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+        };
+
+        if (_socket_path == "-")
+        {
+            serveConnection(std::make_shared<daemon_connection>(STDIN_FILENO, STDOUT_FILENO, false, budget, _options.max_request_size), queue, _options.max_request_size);
+            stop();
+            return 0;
+        }
+
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (_socket_path.size() >= sizeof(address.sun_path))
+        {
+            std::cerr << _socket_path << ": the socket path is too long" << std::endl;
+            stop();
+            return 1;
+        }
+        std::memcpy(address.sun_path, _socket_path.c_str(), _socket_path.size());
+        if (!removeStaleSocket(_socket_path))
+        {
+            std::cerr << _socket_path << ": " << (errno == EEXIST ? "exists and is not a socket" : std::strerror(errno)) << std::endl;
+            stop();
+            return 1;
+        }
+        const int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0
+            || ::bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listen_fd, SOMAXCONN) != 0)
+        {
+            std::cerr << _socket_path << ": " << std::strerror(errno) << std::endl;
+            if (listen_fd >= 0)
+            {
+                ::close(listen_fd);
+            }
+            stop();
+            return 1;
+        }
+        for (;;)
+        {
+            slots->acquire();
+            const int client_fd = ::accept(listen_fd, nullptr, nullptr);
+            if (client_fd < 0)
+            {
+                slots->release();
+                if (errno == EINTR || errno == ECONNABORTED || errno == EMFILE || errno == ENFILE)
+                {
+                    continue;
+                }
+                std::cerr << _socket_path << ": " << std::strerror(errno) << std::endl;
+                break;
+            }
+            // the thread of a connection ends with it, the socket is closed when its last response is written.
+            std::shared_ptr<daemon_connection> connection = std::make_shared<daemon_connection>(client_fd, client_fd, true, budget, _options.max_request_size,
+                std::chrono::seconds(_options.timeout_seconds));
+            const uint64_t max_request_size = _options.max_request_size;
+            std::thread([connection, queue, slots, max_request_size]()
+            {
+                serveConnection(connection, queue, max_request_size);
+                slots->release();
+            }).detach();
+        }
+        ::close(listen_fd);
+        removeStaleSocket(_socket_path);
+        stop();
         return 1;
     }
+#endif
 
-    // get the sorted nodes
-    bimpp::plan2d::algorithm<>::room_ex_vector bim_room_exs;
-    if (!bimpp::plan2d::algorithm<>::computeRoomExs(bim_house, bim_room_exs))
+    int loadBatch(const std::string& _source, size_t _thread_count)
+    {
+        std::vector<std::string> paths;
+        if (!collectPaths(_source, paths))
+        {
+            return 1;
+        }
+
+        std::vector<loader_type::batch_result> results;
+        const loader_type::batch_summary summary = loader_type::load_many(paths, results, true, _thread_count);
+        for (const loader_type::batch_result& result : results)
+        {
+            if (!result.success)
+            {
+                std::cerr << result.path << ": " << (result.error.empty() ? "invalid plan" : result.error) << std::endl;
+            }
+        }
+
+        const double seconds = summary.seconds > 0.0 ? summary.seconds : 1e-9;
+        std::cout << "files: " << summary.file_count
+            << ", failed: " << summary.failed_count
+            << ", threads: " << summary.thread_count
+            << ", seconds: " << summary.seconds
+            << ", files/s: " << summary.file_count / seconds
+            << ", MB/s: " << summary.bytes / seconds / (1024.0 * 1024.0)
+            << std::endl;
+        return summary.failed_count == 0 ? 0 : 1;
+    }
+}
+
+// gcc takes the inlined `std::free` of a replaced `operator delete` for a mismatch with the new expressions.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t _size)
+{
+    if (allocation_counting.load(std::memory_order_relaxed))
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* block = std::malloc(_size > 0 ? _size : 1);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* _block) noexcept
+{
+    std::free(_block);
+}
+
+void operator delete(void* _block, size_t) noexcept
+{
+    std::free(_block);
+}
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+int main(int argc, char* argv[])
+{
+#if defined(WIN32) && !defined(NDEBUG)
+    _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+    // svgex <file.svg>
+    // svgex --batch <directory|list.txt> [thread-count]
+    // svgex --cache <cache-directory> <file.svg>
+    // svgex --stats <file.svg>
+    // svgex --lenient <file.svg>
+    // svgex --daemon <socket-path|-> [thread-count] [max-request-MiB] [timeout-seconds]
+    if (argc == 2)
+    {
+        return loadOne(argv[1]);
+    }
+    if (argc == 3
+        && std::string(argv[1]) == "--stats")
     {
+        return loadStats(argv[2]);
+    }
+    if (argc == 3
+        && std::string(argv[1]) == "--lenient")
+    {
+        return loadLenient(argv[2]);
+    }
+    if (argc >= 3 && argc <= 6
+        && std::string(argv[1]) == "--daemon")
+    {
+#if defined(WIN32)
+        std::cerr << "the daemon is not supported on this platform" << std::endl;
         return 1;
+#else
+        daemon_options options;
+        options.thread_count = argc >= 4 ? static_cast<size_t>(std::strtoul(argv[3], nullptr, 10)) : 0;
+        if (argc >= 5)
+        {
+            options.max_request_size = std::max<uint64_t>(std::strtoull(argv[4], nullptr, 10), 1) << 20;
+        }
+        if (argc == 6)
+        {
+            options.timeout_seconds = static_cast<unsigned>(std::strtoul(argv[5], nullptr, 10));
+        }
+        return serveDaemon(argv[2], options);
+#endif
+    }
+    if (argc == 4
+        && std::string(argv[1]) == "--cache")
+    {
+        return loadCached(argv[3], argv[2]);
+    }
+    if ((argc == 3 || argc == 4)
+        && std::string(argv[1]) == "--batch")
+    {
+        const size_t thread_count = argc == 4 ? static_cast<size_t>(std::strtoul(argv[3], nullptr, 10)) : 0;
+        return loadBatch(argv[2], thread_count);
     }
-    return 0;
+    return 1;
 }